@@ -0,0 +1,32 @@
+#version 330 core
+
+layout (location = 0) in vec2 a_Position;
+layout (location = 1) in vec2 a_Velocity;
+layout (location = 2) in vec2 a_Size;
+layout (location = 3) in vec2 a_SizeSpeed;
+layout (location = 4) in vec4 a_Color;
+layout (location = 5) in float a_TimeOfLiving;
+
+uniform vec4 u_ColorSpeed;
+uniform float u_DeltaTime;
+
+out vec2 v_Position;
+out vec2 v_Velocity;
+out vec2 v_Size;
+out vec2 v_SizeSpeed;
+out vec4 v_Color;
+out float v_TimeOfLiving;
+
+void main()
+{
+	// speeds are per frame, lifetime is in seconds; dead particles are carried over untouched
+	bool alive = a_TimeOfLiving > 0.0f;
+	float step = alive ? 1.0f : 0.0f;
+
+	v_Position = a_Position + a_Velocity * step;
+	v_Velocity = a_Velocity;
+	v_Size = a_Size + a_SizeSpeed * step;
+	v_SizeSpeed = a_SizeSpeed;
+	v_Color = a_Color + u_ColorSpeed * step;
+	v_TimeOfLiving = a_TimeOfLiving - u_DeltaTime * step;
+}
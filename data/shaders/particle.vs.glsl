@@ -0,0 +1,42 @@
+#version 330 core
+
+layout (location = 0) in vec2 a_VertexPosition;
+layout (location = 1) in vec2 a_TextureCoord;
+
+layout (location = 2) in vec2 ai_Position;
+layout (location = 3) in vec2 ai_Size;
+layout (location = 4) in vec4 ai_Color;
+layout (location = 5) in float ai_TimeOfLiving;
+
+layout (std140) uniform FrameConstants
+{
+	mat4 u_WorldViewProjection;
+	mat4 u_UIViewProjection;
+};
+
+uniform vec2 u_SubTexSize;
+uniform vec2 u_SubTexOrigin;
+uniform float u_Depth;
+
+out highp vec2 v_TextureCoord;
+out highp vec2 v_SubTexSize;
+out highp vec2 v_SubTexOrigin;
+out highp vec4 v_QuadColor;
+
+void main()
+{
+	v_TextureCoord = a_TextureCoord;
+	v_SubTexSize = u_SubTexSize;
+	v_SubTexOrigin = u_SubTexOrigin;
+	v_QuadColor = ai_Color;
+
+	if (ai_TimeOfLiving <= 0.0f)
+	{
+		// outside the clip volume, so the whole quad is dropped before rasterization
+		gl_Position = vec4(2.0f, 2.0f, 2.0f, 1.0f);
+		return;
+	}
+
+	vec4 position = vec4(a_VertexPosition * ai_Size + ai_Position, -u_Depth, 1.0f);
+	gl_Position = u_WorldViewProjection * position;
+}
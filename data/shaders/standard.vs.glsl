@@ -14,9 +14,11 @@ layout (location = 8) in vec2 ai_Scale;
 layout (location = 9) in float ai_Rotation;
 layout (location = 10) in float ai_IsUI;
 
-uniform mat4 u_Projection;
-uniform mat4 u_Viewport;
-uniform mat4 u_Camera;
+layout (std140) uniform FrameConstants
+{
+	mat4 u_WorldViewProjection;
+	mat4 u_UIViewProjection;
+};
 
 out highp vec2 v_TextureCoord;
 out highp vec2 v_SubTexSize;
@@ -46,7 +48,7 @@ void main()
 	vec4 position = vec4(rotatedVertexPosition + ai_QuadPosition.xy, -ai_QuadPosition.z, 1.0f);
 
 	if(ai_IsUI < 0.5f)
-		gl_Position = u_Projection * u_Viewport * u_Camera * position;
+		gl_Position = u_WorldViewProjection * position;
 	else
-		gl_Position = u_Projection * u_Viewport * position;
+		gl_Position = u_UIViewProjection * position;
 }
@@ -0,0 +1,20 @@
+#version 330 core
+
+uniform sampler2D u_Texture;
+
+in highp vec2 v_TextureCoord;
+in highp vec2 v_SubTexSize;
+in highp vec2 v_SubTexOrigin;
+
+in vec4 v_QuadColor;
+
+out vec4 o_FragColor;
+
+void main()
+{
+	// 0.5 is the glyph outline; the smoothing band is one screen pixel wide at any scale
+	float distance = texture(u_Texture, v_SubTexOrigin + v_TextureCoord * v_SubTexSize).r;
+	float smoothing = fwidth(distance) * 0.5;
+	float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+	o_FragColor = vec4(v_QuadColor.rgb, v_QuadColor.a * alpha);
+}
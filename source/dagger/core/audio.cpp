@@ -3,16 +3,81 @@
 #include <core/core.h>
 #include <core/engine.h>
 
+#include <algorithm>
+#include <cstdlib>
+
 using namespace dagger;
 
 void Audio::Initialize()
 {
 	m_SoLoud.init();
+	auto& ini = Engine::GetIniFile();
+	m_StreamAbove = std::strtoull(ini.GetValue("audio", "stream-above", "1024"), nullptr, 10) * 1024;
+	m_Budget = std::strtoull(ini.GetValue("audio", "budget", "65536"), nullptr, 10) * 1024;
+
+	// voices past this are still tracked but not mixed, so the mixer's cost has a ceiling
+	m_SoLoud.setMaxActiveVoiceCount(atoi(ini.GetValue("audio", "max-voices", "32")));
+
+	IniFile::TNamesDepend groups;
+	ini.GetAllKeys("audio-groups", groups);
+	for (const auto& group : groups)
+	{
+		m_Groups.push_back(VoiceGroup {group.pItem, (UInt32)atoi(ini.GetValue("audio-groups", group.pItem, "0"))});
+	}
+}
+
+UInt32 Audio::GroupId(const String& name_)
+{
+	for (UInt32 i = 0; i < m_Groups.size(); i++)
+	{
+		if (m_Groups[i].name == name_)
+			return i;
+	}
+
+	// groups only named in metadata have no limit of their own
+	m_Groups.push_back(VoiceGroup {name_, 0});
+	return m_Groups.size() - 1;
+}
+
+void Audio::ReadMetadata(Sound& sound_, const FilePath& path_)
+{
+	std::error_code error;
+	const auto size = Files::file_size(path_, error);
+	sound_.mode = !error && size > m_StreamAbove ? ESoundMode::Streamed : ESoundMode::Loaded;
+	sound_.group = Sound::s_NoGroup;
+	sound_.maxVoices = 0;
+	sound_.priority = 0;
+	sound_.cooldown = 0;
+
+	FilePath metadataPath {path_};
+	metadataPath.replace_extension(".json");
+	if (!Files::exists(metadataPath))
+		return;
+
+	FileInputStream handle {metadataPath, std::ios::in};
+	JSON::json metadata = JSON::json::parse(handle, nullptr, false);
+	if (!metadata.is_object())
+	{
+		Logger::warn("Couldn't read sound metadata from {}", metadataPath.string());
+		return;
+	}
+
+	if (metadata.contains("stream"))
+		sound_.mode = metadata["stream"].get<bool>() ? ESoundMode::Streamed : ESoundMode::Loaded;
+	else if (metadata.value("music", false))
+		sound_.mode = ESoundMode::Streamed;
+
+	if (metadata.contains("group"))
+		sound_.group = GroupId(metadata["group"].get<String>());
+
+	sound_.maxVoices = metadata.value("max-voices", 0u);
+	sound_.priority = metadata.value("priority", 0);
+	sound_.cooldown = metadata.value("cooldown", 0u);
 }
 
 void Audio::Load(AssetLoadRequest<Sound> request_)
 {
-	Logger::info("Loading sound {}...", request_.path);
+	Logger::info("Registering sound {}...", request_.path);
 
 	FilePath path {request_.path};
 	String name = path.stem().string();
@@ -33,37 +98,244 @@ void Audio::Load(AssetLoadRequest<Sound> request_)
 	auto& sounds = Engine::Res<Sound>();
 
 	if (!sounds.contains(soundName))
+	{
 		sounds[soundName] = new Sound();
+		sounds[soundName]->id = m_Sounds.size();
+		m_Sounds.push_back(sounds[soundName]);
+	}
 
+	// a sound registered again is decoded again from the new file when next used
 	auto* sound = sounds[soundName];
+	if (sound->source != nullptr)
+		Evict(*sound);
+
 	sound->name = soundName;
 	sound->path = request_.path;
-	sound->source.load(request_.path.c_str());
+	ReadMetadata(*sound, path);
 }
 
-unsigned Audio::Play(String name_, float volume_)
+Bool Audio::Decode(Sound& sound_)
 {
-	auto& sounds = Engine::Res<Sound>();
-	assert(sounds.contains(name_));
+	SoLoud::result result;
+	if (sound_.mode == ESoundMode::Streamed)
+	{
+		// only opens the file, decoding happens on the mixer thread as the sound plays
+		auto* stream = new SoLoud::WavStream();
+		result = stream->load(sound_.path.c_str());
+		sound_.source.reset(stream);
+		sound_.bytes = 0;
+	}
+	else
+	{
+		auto* wav = new SoLoud::Wav();
+		result = wav->load(sound_.path.c_str());
+		sound_.source.reset(wav);
+		sound_.bytes = static_cast<UInt64>(wav->mSampleCount) * wav->mChannels * sizeof(Float32);
+	}
 
-	SoLoud::handle handle = m_SoLoud.play(sounds[name_]->source);
-	m_SoLoud.setVolume(handle, volume_);
+	if (result != SoLoud::SO_NO_ERROR)
+	{
+		Logger::error("Couldn't load sound {}: {}", sound_.path, m_SoLoud.getErrorString(result));
+		sound_.source.reset();
+		sound_.bytes = 0;
+		return false;
+	}
 
-	return handle;
+	m_Resident.push_back(&sound_);
+	m_ResidentBytes += sound_.bytes;
+	TrimToBudget(&sound_);
+	return true;
 }
 
-unsigned Audio::PlayLoop(String name_, float volume_)
+void Audio::Evict(Sound& sound_)
 {
-	auto& sounds = Engine::Res<Sound>();
-	assert(sounds.contains(name_));
+	auto found = std::find(m_Resident.begin(), m_Resident.end(), &sound_);
+	if (found != m_Resident.end())
+	{
+		*found = m_Resident.back();
+		m_Resident.pop_back();
+	}
+
+	m_ResidentBytes -= sound_.bytes;
+	sound_.bytes = 0;
+	sound_.source.reset();
+}
+
+void Audio::TrimToBudget(const Sound* keep_)
+{
+	while (m_Budget != 0 && m_ResidentBytes > m_Budget)
+	{
+		// destroying a source stops its voices, so anything playing stays
+		Sound* oldest = nullptr;
+		for (auto* sound : m_Resident)
+		{
+			if (sound == keep_ || sound->bytes == 0 || m_SoLoud.countAudioSource(*sound->source) > 0)
+				continue;
+
+			if (oldest == nullptr || sound->lastUsed < oldest->lastUsed)
+				oldest = sound;
+		}
+
+		if (oldest == nullptr)
+			break;
+
+		Logger::info("Evicting sound {} to stay within the audio budget", oldest->name);
+		Evict(*oldest);
+		m_Evictions++;
+	}
+}
+
+Bool Audio::Acquire(Sound& sound_)
+{
+	sound_.lastUsed = ++m_UseCounter;
+	return sound_.source != nullptr || Decode(sound_);
+}
+
+UInt32 Audio::Id(const String& name_) const
+{
+	const auto& sounds = Engine::Res<Sound>();
+	auto found = sounds.find(name_);
+	return found != sounds.end() && found->second != nullptr ? found->second->id : s_NoSound;
+}
+
+void Audio::PruneVoices()
+{
+	m_Voices.erase(
+		std::remove_if(
+			m_Voices.begin(), m_Voices.end(),
+			[this](const Voice& voice_) { return !m_SoLoud.isValidVoiceHandle(voice_.handle); }),
+		m_Voices.end());
+}
 
-	SoLoud::handle handle = m_SoLoud.play(sounds[name_]->source);
-	m_SoLoud.setLooping(handle, true);
-	m_SoLoud.setVolume(handle, volume_);
+SInt32 Audio::FindVictim(const Sound& sound_, Bool wholeGroup_, SInt32 stopping_) const
+{
+	const UInt32 limit = wholeGroup_ ? m_Groups[sound_.group].maxVoices : sound_.maxVoices;
+	if (limit == 0)
+		return s_NoVictim;
+
+	UInt32 count = 0;
+	SInt32 victim = s_NoVictim;
+	for (SInt32 i = 0; i < (SInt32)m_Voices.size(); i++)
+	{
+		const auto& voice = m_Voices[i];
+		const Bool isCounted = wholeGroup_ ? m_Sounds[voice.sound]->group == sound_.group : voice.sound == sound_.id;
+		if (i == stopping_ || !isCounted)
+			continue;
+
+		count++;
 
+		// voices are kept oldest first, so the first one with the lowest priority is also the oldest of those
+		if (victim == s_NoVictim || voice.priority < m_Voices[victim].priority)
+			victim = i;
+	}
+
+	if (count < limit)
+		return s_NoVictim;
+
+	return m_Voices[victim].priority > sound_.priority ? s_Rejected : victim;
+}
+
+unsigned Audio::Start(UInt32 sound_, Float32 volume_, Bool loop_)
+{
+	if (sound_ >= m_Sounds.size())
+	{
+		Logger::warn("Tried to play sound {}, which doesn't exist", sound_);
+		return 0;
+	}
+
+	auto& sound = *m_Sounds[sound_];
+	const TimePoint now = TimeSnapshot();
+	if (sound.cooldown > 0 && sound.lastStarted != TimePoint {} &&
+		DurationToMilliseconds(now - sound.lastStarted) < (SInt64)sound.cooldown)
+	{
+		m_RejectedVoices++;
+		return 0;
+	}
+
+	// nothing is stopped until the new voice is sure to start
+	PruneVoices();
+	const SInt32 soundVictim = FindVictim(sound, false, s_NoVictim);
+	SInt32 groupVictim = s_NoVictim;
+	if (sound.group != Sound::s_NoGroup && soundVictim != s_Rejected)
+		groupVictim = FindVictim(sound, true, soundVictim);
+
+	if (soundVictim == s_Rejected || groupVictim == s_Rejected)
+	{
+		m_RejectedVoices++;
+		return 0;
+	}
+
+	if (!Acquire(sound))
+		return 0;
+
+	// the later one goes first, so erasing it doesn't move the other
+	for (SInt32 victim : {std::max(soundVictim, groupVictim), std::min(soundVictim, groupVictim)})
+	{
+		if (victim == s_NoVictim)
+			continue;
+
+		m_SoLoud.stop(m_Voices[victim].handle);
+		m_Voices.erase(m_Voices.begin() + victim);
+		m_StolenVoices++;
+	}
+
+	SoLoud::handle handle = m_SoLoud.play(*sound.source, volume_);
+	if (loop_)
+	{
+		// loops are usually music or ambience, they shouldn't drop out when the mixer is busy
+		m_SoLoud.setLooping(handle, true);
+		m_SoLoud.setProtectVoice(handle, true);
+	}
+
+	m_Voices.push_back(Voice {handle, sound_, sound.priority});
+	sound.lastStarted = now;
 	return handle;
 }
 
+Bool Audio::Prefetch(UInt32 sound_)
+{
+	return sound_ < m_Sounds.size() && Acquire(*m_Sounds[sound_]);
+}
+
+unsigned Audio::Play(UInt32 sound_, float volume_)
+{
+	return Start(sound_, volume_, false);
+}
+
+unsigned Audio::PlayLoop(UInt32 sound_, float volume_)
+{
+	return Start(sound_, volume_, true);
+}
+
+Bool Audio::Prefetch(const String& name_)
+{
+	return Prefetch(Id(name_));
+}
+
+unsigned Audio::Play(String name_, float volume_)
+{
+	const UInt32 sound = Id(name_);
+	if (sound == s_NoSound)
+	{
+		Logger::warn("There is no sound named {}", name_);
+		return 0;
+	}
+
+	return Start(sound, volume_, false);
+}
+
+unsigned Audio::PlayLoop(String name_, float volume_)
+{
+	const UInt32 sound = Id(name_);
+	if (sound == s_NoSound)
+	{
+		Logger::warn("There is no sound named {}", name_);
+		return 0;
+	}
+
+	return Start(sound, volume_, true);
+}
+
 void Audio::Pause(unsigned handle_, bool pause_)
 {
 	m_SoLoud.setPause(handle_, pause_);
@@ -94,6 +366,28 @@ void Audio::Uninitialize()
 	}
 
 	Engine::Res<Sound>().clear();
+	m_Sounds.clear();
+	m_Groups.clear();
+	m_Voices.clear();
+	m_Resident.clear();
+	m_ResidentBytes = 0;
+}
+
+AudioStats Audio::Stats()
+{
+	AudioStats stats {};
+	stats.registered = m_Sounds.size();
+	stats.resident = m_Resident.size();
+	stats.residentBytes = m_ResidentBytes;
+	stats.budgetBytes = m_Budget;
+	stats.evictions = m_Evictions;
+
+	stats.activeVoices = m_SoLoud.getActiveVoiceCount();
+	stats.maxActiveVoices = m_SoLoud.getMaxActiveVoiceCount();
+	stats.virtualVoices = m_SoLoud.getVoiceCount() - stats.activeVoices;
+	stats.stolenVoices = m_StolenVoices;
+	stats.rejectedVoices = m_RejectedVoices;
+	return stats;
 }
 
 void AudioSystem::OnLoadAsset(AssetLoadRequest<Sound> request_)
@@ -5,20 +5,77 @@
 
 #include <soloud.h>
 #include <soloud_wav.h>
+#include <soloud_wavstream.h>
 
 #include <string>
 
+// ESoundMode: Loaded sounds are decoded into memory when loaded, Streamed ones are decoded bit by bit while playing.
+enum class ESoundMode
+{
+	Loaded,
+	Streamed
+};
+
+// Sound: a sound is streamed if it is marked as music in its metadata (a .json file next to it, with "music": true),
+// or if it is bigger than [audio] stream-above kilobytes; "stream" in the metadata overrides both.
+// The metadata can also limit its voices: "max-voices" (0 for no limit), "group", "priority" and "cooldown" in ms.
 struct Sound
 {
+	constexpr static UInt32 s_NoGroup = ~0u;
+
 	String name;
 	String path;
-	SoLoud::Wav source;
+	UInt32 id {0};
+	ESoundMode mode {ESoundMode::Loaded};
+
+	UInt32 group {s_NoGroup};
+	UInt32 maxVoices {0};
+	SInt32 priority {0};
+	UInt32 cooldown {0};
+	TimePoint lastStarted {};
+
+	// empty until the sound is first played or prefetched, and again once it is evicted
+	OwningPtr<SoLoud::AudioSource> source;
+	UInt64 bytes {0};
+	UInt64 lastUsed {0};
+};
+
+struct AudioStats
+{
+	UInt32 registered;
+	UInt32 resident;
+	UInt64 residentBytes;
+	UInt64 budgetBytes;
+	UInt32 evictions;
+
+	// voices the mixer is working on, out of how many it will mix, and ones it keeps track of without mixing
+	UInt32 activeVoices;
+	UInt32 maxActiveVoices;
+	UInt32 virtualVoices;
+	UInt32 stolenVoices;
+	UInt32 rejectedVoices;
 };
 
+// Audio: sounds are registered by name when found, and decoded the first time they are played or prefetched.
+// Decoded sounds that push memory over [audio] budget kilobytes evict the least recently used ones that
+// aren't playing; 0 means no budget. Streamed sounds are opened lazily too, but hold almost nothing.
+// A sound at its voice limit, or in a group at its limit ([audio-groups] name=count), stops the oldest voice with
+// the lowest priority that isn't above its own, or doesn't play. The mixer never mixes more than [audio] max-voices.
 struct Audio
 {
+	constexpr static UInt32 s_NoSound = ~0u;
+
 	void Initialize();
 	void Load(AssetLoadRequest<Sound> request_);
+
+	// resolve names once and play by id, s_NoSound if there is no such sound
+	UInt32 Id(const String& name_) const;
+
+	Bool Prefetch(UInt32 sound_);
+	unsigned Play(UInt32 sound_, float volume_ = 1.0f);
+	unsigned PlayLoop(UInt32 sound_, float volume_ = 1.0f);
+
+	Bool Prefetch(const String& name_);
 	unsigned Play(String name_, float volume_ = 1.0f);
 	unsigned PlayLoop(String name_, float volume_ = 1.0f);
 	void Pause(unsigned handle_, bool pause_ = true);
@@ -27,8 +84,56 @@ struct Audio
 	void StopAll();
 	void Uninitialize();
 
+	AudioStats Stats();
+
 private:
+	struct Voice
+	{
+		SoLoud::handle handle;
+		UInt32 sound;
+		SInt32 priority;
+	};
+
+	struct VoiceGroup
+	{
+		String name;
+		UInt32 maxVoices;
+	};
+
 	SoLoud::Soloud m_SoLoud;
+	UInt64 m_StreamAbove {1024 * 1024};
+	UInt64 m_Budget {64 * 1024 * 1024};
+
+	Sequence<Sound*> m_Sounds;
+	Sequence<VoiceGroup> m_Groups;
+
+	// oldest first
+	Sequence<Voice> m_Voices;
+	UInt32 m_StolenVoices {0};
+	UInt32 m_RejectedVoices {0};
+
+	Sequence<Sound*> m_Resident;
+	UInt64 m_ResidentBytes {0};
+	UInt64 m_UseCounter {0};
+	UInt32 m_Evictions {0};
+
+	void ReadMetadata(Sound& sound_, const FilePath& path_);
+	UInt32 GroupId(const String& name_);
+
+	Bool Acquire(Sound& sound_);
+	Bool Decode(Sound& sound_);
+	void Evict(Sound& sound_);
+	void TrimToBudget(const Sound* keep_);
+
+	unsigned Start(UInt32 sound_, Float32 volume_, Bool loop_);
+	void PruneVoices();
+
+	constexpr static SInt32 s_NoVictim = -1;
+	constexpr static SInt32 s_Rejected = -2;
+
+	// the voice that has to stop for sound_ to stay within its own or its group's limit, not counting the one
+	// already stopping; s_NoVictim if none has to, s_Rejected if the sound can't play
+	SInt32 FindVictim(const Sound& sound_, Bool wholeGroup_, SInt32 stopping_) const;
 };
 
 struct AudioSystem : public dagger::System
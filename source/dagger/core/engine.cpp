@@ -1,14 +1,14 @@
 #include "core/engine.h"
 
 #include "core/game.h"
+#include "core/random.h"
 
 #include <SimpleIni.h>
 
 using namespace dagger;
 
-Engine::Engine() : m_Game {}, m_Registry {}, m_EventDispatcher {}, m_ExitStatus {0}
+Engine::Engine() : m_Game {}, m_Registry {}, m_EventDispatcher {}, m_RenderDispatcher {}, m_ExitStatus {0}
 {
-	srand(time(nullptr));
 	Logger::set_level(Logger::level::trace);
 
 	Engine::s_Instance = this;
@@ -30,6 +30,7 @@ void Engine::EngineError(Error& error_)
 void Engine::EngineInit()
 {
 	this->m_EventDispatcher = std::make_unique<entt::dispatcher>();
+	this->m_RenderDispatcher = std::make_unique<entt::dispatcher>();
 	this->m_Registry = std::make_unique<entt::registry>();
 
 	Engine::Dispatcher().sink<Error>().connect<&Engine::EngineError>(*this);
@@ -97,6 +98,7 @@ void Engine::EngineStop()
 	Engine::Dispatcher().sink<Error>().disconnect<&Engine::EngineError>(*this);
 	Engine::Dispatcher().sink<Error>().connect<&Engine::EngineError>(*this);
 
+	this->m_RenderDispatcher.reset();
 	this->m_EventDispatcher.reset();
 	this->m_Registry.reset();
 }
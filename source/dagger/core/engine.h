@@ -2,6 +2,7 @@
 
 #include "core/core.h"
 #include "core/game.h"
+#include "core/random.h"
 #include "system.h"
 
 #include <SimpleIni.h>
@@ -10,6 +11,7 @@
 #include <tsl/sparse_map.h>
 #include <tsl/sparse_set.h>
 
+#include <cstdlib>
 #include <memory>
 #include <typeinfo>
 #include <utility>
@@ -32,6 +34,7 @@ namespace dagger
 		std::vector<System*> m_Systems;
 		OwningPtr<entt::registry> m_Registry;
 		OwningPtr<entt::dispatcher> m_EventDispatcher;
+		OwningPtr<entt::dispatcher> m_RenderDispatcher;
 		Bool m_ShouldStayUp {true};
 		UInt32 m_ExitStatus;
 
@@ -80,6 +83,13 @@ namespace dagger
 			return s_Instance->m_CurrentTime;
 		}
 
+		// Replays feed the recorded clock back in, so systems running after this see the recorded frame's time.
+		static inline void OverrideFrameTime(TimePoint now_, Float32 deltaTime_)
+		{
+			s_Instance->m_CurrentTime = now_;
+			s_Instance->m_DeltaTime = Duration {deltaTime_};
+		}
+
 		static inline UInt64 FrameCount()
 		{
 			return s_Instance->m_FrameCounter;
@@ -90,6 +100,13 @@ namespace dagger
 			return *(s_Instance->m_EventDispatcher.get());
 		}
 
+		// RenderDispatcher: events fired while a frame is being submitted to the GPU.
+		// With pipelined rendering these run on the render thread, so only render code should listen here.
+		static inline entt::dispatcher& RenderDispatcher()
+		{
+			return *(s_Instance->m_RenderDispatcher.get());
+		}
+
 		static inline entt::registry& Registry()
 		{
 			return *(s_Instance->m_Registry.get());
@@ -164,6 +181,8 @@ namespace dagger
 				exit(-1);
 			}
 
+			Random::Seed(std::strtoull(m_Ini.GetValue("engine", "seed", "0"), nullptr, 10));
+
 			m_Game->CoreSystemsSetup();
 			m_Game->GameplaySystemsSetup();
 
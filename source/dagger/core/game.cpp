@@ -6,10 +6,12 @@
 #include "core/game/transforms.h"
 #include "core/graphics/animation.h"
 #include "core/graphics/animations.h"
+#include "core/graphics/gpu_particles.h"
 #include "core/graphics/gui.h"
 #include "core/graphics/shaders.h"
 #include "core/graphics/sprite.h"
 #include "core/graphics/sprite_render.h"
+#include "core/graphics/text.h"
 #include "core/graphics/textures.h"
 #include "core/graphics/tool_render.h"
 #include "core/graphics/window.h"
@@ -26,6 +28,8 @@ void dagger::Game::CoreSystemsSetup()
 	engine.AddSystem<TextureSystem>();
 	engine.AddSystem<TransformSystem>();
 	engine.AddSystem<SpriteRenderSystem>();
+	engine.AddSystem<GPUParticleSystem>();
+	engine.AddSystem<TextSystem>();
 	engine.AddSystem<AnimationSystem>();
 #if !defined(NDEBUG)
 	engine.AddSystem<DiagnosticSystem>();
@@ -0,0 +1,108 @@
+#include "distance_field.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace dagger;
+
+constexpr static Float32 s_Infinity = 1e20f;
+
+// squared distance transform of one row or column, f_ holds 0 on feature cells and infinity elsewhere
+static void DistanceTransform1D(
+	const Float32* f_, Float32* d_, UInt32 n_, Sequence<UInt32>& v_, Sequence<Float32>& z_)
+{
+	v_.resize(n_);
+	z_.resize(n_ + 1);
+
+	UInt32 k = 0;
+	v_[0] = 0;
+	z_[0] = -s_Infinity;
+	z_[1] = s_Infinity;
+
+	for (UInt32 q = 1; q < n_; q++)
+	{
+		auto intersection = [&](UInt32 p_)
+		{
+			return ((f_[q] + (Float32)(q * q)) - (f_[p_] + (Float32)(p_ * p_))) / (2.0f * (Float32)(q - p_));
+		};
+
+		Float32 s = intersection(v_[k]);
+		while (s <= z_[k])
+		{
+			k--;
+			s = intersection(v_[k]);
+		}
+
+		k++;
+		v_[k] = q;
+		z_[k] = s;
+		z_[k + 1] = s_Infinity;
+	}
+
+	k = 0;
+	for (UInt32 q = 0; q < n_; q++)
+	{
+		while (z_[k + 1] < (Float32)q)
+			k++;
+
+		const Float32 delta = (Float32)q - (Float32)v_[k];
+		d_[q] = delta * delta + f_[v_[k]];
+	}
+}
+
+// squared distance of every cell to the nearest cell where feature_ returns true
+template<typename Feature>
+static Sequence<Float32> SquaredDistance(UInt32 width_, UInt32 height_, Feature&& feature_)
+{
+	Sequence<Float32> grid(width_ * height_);
+	for (UInt32 i = 0; i < width_ * height_; i++)
+	{
+		grid[i] = feature_(i) ? 0.0f : s_Infinity;
+	}
+
+	const UInt32 longest = std::max(width_, height_);
+	Sequence<Float32> f(longest), d(longest), z;
+	Sequence<UInt32> v;
+
+	for (UInt32 x = 0; x < width_; x++)
+	{
+		for (UInt32 y = 0; y < height_; y++)
+			f[y] = grid[y * width_ + x];
+
+		DistanceTransform1D(f.data(), d.data(), height_, v, z);
+
+		for (UInt32 y = 0; y < height_; y++)
+			grid[y * width_ + x] = d[y];
+	}
+
+	for (UInt32 y = 0; y < height_; y++)
+	{
+		DistanceTransform1D(&grid[y * width_], d.data(), width_, v, z);
+		std::copy(d.begin(), d.begin() + width_, grid.begin() + y * width_);
+	}
+
+	return grid;
+}
+
+Sequence<Float32> dagger::SignedDistanceField(const Sequence<UInt8>& mask_, UInt32 width_, UInt32 height_)
+{
+	assert(mask_.size() == width_ * height_);
+
+	if (width_ == 0 || height_ == 0)
+		return {};
+
+	auto toInside = SquaredDistance(width_, height_, [&](UInt32 i_) { return mask_[i_] != 0; });
+	auto toOutside = SquaredDistance(width_, height_, [&](UInt32 i_) { return mask_[i_] == 0; });
+
+	Sequence<Float32> field(width_ * height_);
+	for (UInt32 i = 0; i < width_ * height_; i++)
+	{
+		// a cell is half a cell away from the outline it borders
+		if (mask_[i] != 0)
+			field[i] = -(std::sqrt(toOutside[i]) - 0.5f);
+		else
+			field[i] = std::sqrt(toInside[i]) - 0.5f;
+	}
+
+	return field;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "core/core.h"
+
+namespace dagger
+{
+	// SignedDistanceField: distance from the center of every cell of a mask to the closest cell on the
+	// other side of its outline, measured in cells. Negative inside the mask (non-zero cells), positive outside.
+	// Uses the separable exact Euclidean distance transform (Felzenszwalb & Huttenlocher), linear in the cell count.
+	Sequence<Float32> SignedDistanceField(const Sequence<UInt8>& mask_, UInt32 width_, UInt32 height_);
+} // namespace dagger
@@ -0,0 +1,97 @@
+#include "gl_state.h"
+
+using namespace dagger;
+
+Bool GLState::Change(GLuint& current_, GLuint next_)
+{
+	if (current_ == next_)
+	{
+		s_Skipped++;
+		return false;
+	}
+
+	current_ = next_;
+	s_Issued++;
+	return true;
+}
+
+void GLState::UseProgram(GLuint program_)
+{
+	if (Change(s_Program, program_))
+		glUseProgram(program_);
+}
+
+void GLState::BindVertexArray(GLuint vertexArray_)
+{
+	if (Change(s_VertexArray, vertexArray_))
+		glBindVertexArray(vertexArray_);
+}
+
+void GLState::BindBuffer(GLenum target_, GLuint buffer_)
+{
+	switch (target_)
+	{
+	case GL_ARRAY_BUFFER:
+		if (Change(s_ArrayBuffer, buffer_))
+			glBindBuffer(target_, buffer_);
+		break;
+	case GL_UNIFORM_BUFFER:
+		if (Change(s_UniformBuffer, buffer_))
+			glBindBuffer(target_, buffer_);
+		break;
+	default:
+		// element array bindings live in the bound vertex array, so they are not tracked here
+		s_Issued++;
+		glBindBuffer(target_, buffer_);
+		break;
+	}
+}
+
+void GLState::ActiveTexture(GLenum unit_)
+{
+	assert(unit_ >= GL_TEXTURE0 && unit_ < GL_TEXTURE0 + s_TextureUnitCount);
+
+	if (Change(s_ActiveTexture, unit_))
+		glActiveTexture(unit_);
+}
+
+void GLState::BindTexture(GLenum target_, GLuint texture_)
+{
+	if (target_ != GL_TEXTURE_2D)
+	{
+		s_Issued++;
+		glBindTexture(target_, texture_);
+		return;
+	}
+
+	if (Change(s_Textures2D[s_ActiveTexture - GL_TEXTURE0], texture_))
+		glBindTexture(target_, texture_);
+}
+
+void GLState::Invalidate()
+{
+	s_Program = s_Unknown;
+	s_VertexArray = s_Unknown;
+	s_ArrayBuffer = s_Unknown;
+	s_UniformBuffer = s_Unknown;
+	s_Textures2D.fill(s_Unknown);
+
+	// the active unit is pinned instead of forgotten, texture slots are indexed by it
+	glActiveTexture(GL_TEXTURE0);
+	s_ActiveTexture = GL_TEXTURE0;
+}
+
+void GLState::NextFrame()
+{
+	s_LastIssued = s_Issued;
+	s_LastSkipped = s_Skipped;
+	s_Issued = 0;
+	s_Skipped = 0;
+
+	Invalidate();
+}
+
+GLStateStats GLState::LastFrameStats()
+{
+	return GLStateStats {s_LastIssued.load(), s_LastSkipped.load()};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <glad/glad.h>
+
+#include <atomic>
+
+using namespace dagger;
+
+// GLStateStats: state changes made through GLState during the last finished frame.
+struct GLStateStats
+{
+	UInt32 issued {0};
+	UInt32 skipped {0};
+};
+
+// GLState: remembers the bindings engine render code has made and drops calls that would not change anything.
+// Only the thread owning the GL context may call into it. Anything that touches GL behind its back
+// (ImGui, deleting objects) must be followed by Invalidate(); WindowSystem does so at the start of every frame.
+class GLState
+{
+	constexpr static UInt32 s_TextureUnitCount = 16;
+
+	// a name GL never hands out, so the first call after Invalidate() always goes through
+	constexpr static GLuint s_Unknown = ~0u;
+
+	inline static GLuint s_Program {s_Unknown};
+	inline static GLuint s_VertexArray {s_Unknown};
+	inline static GLuint s_ArrayBuffer {s_Unknown};
+	inline static GLuint s_UniformBuffer {s_Unknown};
+	inline static GLenum s_ActiveTexture {GL_TEXTURE0};
+	inline static StaticArray<GLuint, s_TextureUnitCount> s_Textures2D {};
+
+	inline static UInt32 s_Issued {0};
+	inline static UInt32 s_Skipped {0};
+	inline static std::atomic<UInt32> s_LastIssued {0};
+	inline static std::atomic<UInt32> s_LastSkipped {0};
+
+	static Bool Change(GLuint& current_, GLuint next_);
+
+public:
+	static void UseProgram(GLuint program_);
+	static void BindVertexArray(GLuint vertexArray_);
+	static void BindBuffer(GLenum target_, GLuint buffer_);
+	static void ActiveTexture(GLenum unit_);
+	static void BindTexture(GLenum target_, GLuint texture_);
+
+	static void Invalidate();
+	static void NextFrame();
+
+	static GLStateStats LastFrameStats();
+};
@@ -0,0 +1,249 @@
+#include "gpu_particles.h"
+
+#include "core/engine.h"
+#include "core/graphics/gl_state.h"
+#include "core/graphics/gpu_timer.h"
+#include "core/graphics/shaders.h"
+
+#include <algorithm>
+
+using namespace dagger;
+
+static_assert(sizeof(GPUParticle) == sizeof(Float32) * 13, "GPUParticle must match the transform feedback layout");
+
+void GPUParticleSystem::SpinUp()
+{
+	glGenBuffers(1, &m_QuadVBO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_QuadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(m_VerticesAndTexCoords), m_VerticesAndTexCoords, GL_STATIC_DRAW);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+	m_UpdateShader = ShaderSystem::Get("particle-update");
+	m_DrawShader = ShaderSystem::Get("particle");
+
+	m_ColorSpeedLocation = glGetUniformLocation(m_UpdateShader->programId, "u_ColorSpeed");
+	m_DeltaTimeLocation = glGetUniformLocation(m_UpdateShader->programId, "u_DeltaTime");
+	m_SubTexSizeLocation = glGetUniformLocation(m_DrawShader->programId, "u_SubTexSize");
+	m_SubTexOriginLocation = glGetUniformLocation(m_DrawShader->programId, "u_SubTexOrigin");
+	m_DepthLocation = glGetUniformLocation(m_DrawShader->programId, "u_Depth");
+
+	Engine::Dispatcher().sink<RenderExtract>().connect<&GPUParticleSystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<Render>().connect<&GPUParticleSystem::OnRender>(this);
+}
+
+void GPUParticleSystem::CreateBuffers(EmitterBuffers& buffers_, UInt32 capacity_)
+{
+	// every slot starts out dead
+	const Sequence<GPUParticle> empty(capacity_);
+
+	buffers_.capacity = capacity_;
+	glGenBuffers(2, buffers_.particles.data());
+	glGenVertexArrays(2, buffers_.updateVAO.data());
+	glGenVertexArrays(2, buffers_.drawVAO.data());
+
+	const GLsizei stride = sizeof(GPUParticle);
+	const auto offset = [](UInt64 floats_) { return (void*)(sizeof(Float32) * floats_); }; // NOLINT
+
+	for (UInt32 i = 0; i < 2; i++)
+	{
+		GLState::BindBuffer(GL_ARRAY_BUFFER, buffers_.particles[i]);
+		glBufferData(GL_ARRAY_BUFFER, stride * capacity_, empty.data(), GL_DYNAMIC_COPY);
+
+		// update pass: one point per particle, every attribute
+		GLState::BindVertexArray(buffers_.updateVAO[i]);
+		const StaticArray<Pair<UInt32, UInt32>, 6> sizesAndStrides = {
+			pair(2, 0),	 // #0: position
+			pair(2, 2),	 // #1: velocity
+			pair(2, 4),	 // #2: size
+			pair(2, 6),	 // #3: size speed
+			pair(4, 8),	 // #4: color
+			pair(1, 12), // #5: time of living
+		};
+
+		for (UInt32 attribute = 0; attribute < sizesAndStrides.size(); attribute++)
+		{
+			glVertexAttribPointer(
+				attribute, sizesAndStrides[attribute].first, GL_FLOAT, GL_FALSE, stride,
+				offset(sizesAndStrides[attribute].second));
+			glEnableVertexAttribArray(attribute);
+		}
+
+		// draw pass: the shared quad, then one instance per particle
+		GLState::BindVertexArray(buffers_.drawVAO[i]);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, m_QuadVBO);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Float32) * 4, offset(0));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Float32) * 4, offset(2));
+		glEnableVertexAttribArray(1);
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, buffers_.particles[i]);
+		const StaticArray<Pair<UInt32, UInt32>, 4> instanceSizesAndStrides = {
+			pair(2, 0),	 // #2: position
+			pair(2, 4),	 // #3: size
+			pair(4, 8),	 // #4: color
+			pair(1, 12), // #5: time of living
+		};
+
+		for (UInt32 j = 0; j < instanceSizesAndStrides.size(); j++)
+		{
+			const UInt32 attribute = 2 + j;
+			glVertexAttribPointer(
+				attribute, instanceSizesAndStrides[j].first, GL_FLOAT, GL_FALSE, stride,
+				offset(instanceSizesAndStrides[j].second));
+			glEnableVertexAttribArray(attribute);
+			glVertexAttribDivisor(attribute, 1);
+		}
+	}
+
+	GLState::BindVertexArray(0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GPUParticleSystem::DeleteBuffers(EmitterBuffers& buffers_)
+{
+	glDeleteVertexArrays(2, buffers_.drawVAO.data());
+	glDeleteVertexArrays(2, buffers_.updateVAO.data());
+	glDeleteBuffers(2, buffers_.particles.data());
+
+	// names may be handed out again, the tracker must not assume they are still bound
+	GLState::Invalidate();
+}
+
+void GPUParticleSystem::UploadSpawns(EmitterBuffers& buffers_, const Sequence<GPUParticle>& spawns_)
+{
+	if (spawns_.empty())
+		return;
+
+	// more spawns than slots: only the newest ones would survive anyway
+	const UInt32 count = std::min<UInt32>(spawns_.size(), buffers_.capacity);
+	const GPUParticle* data = spawns_.data() + (spawns_.size() - count);
+
+	GLState::BindBuffer(GL_ARRAY_BUFFER, buffers_.particles[buffers_.source]);
+
+	// the slots form a ring, so a frame's spawns are written in at most two pieces
+	const UInt32 first = std::min(count, buffers_.capacity - buffers_.head);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(GPUParticle) * buffers_.head, sizeof(GPUParticle) * first, data);
+	if (first < count)
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GPUParticle) * (count - first), data + first);
+
+	buffers_.head = (buffers_.head + count) % buffers_.capacity;
+}
+
+void GPUParticleSystem::OnRenderExtract(RenderExtract extract_)
+{
+	auto& frame = m_Frames[extract_.buffer];
+	m_DeltaTimes[extract_.buffer] = Engine::DeltaTime();
+
+	auto emitters = Engine::Registry().view<GPUParticleEmitter>();
+	frame.resize(emitters.size());
+
+	UInt32 index = 0;
+	for (auto entity : emitters)
+	{
+		auto& emitter = emitters.get<GPUParticleEmitter>(entity);
+		frame[index].entity = entity;
+		frame[index].emitter = emitter;
+		index++;
+
+		// spawns go to the GPU exactly once
+		emitter.spawns.clear();
+	}
+}
+
+void GPUParticleSystem::OnRender(Render render_)
+{
+	const auto& frame = m_Frames[render_.buffer];
+	if (frame.empty() && m_Buffers.empty())
+		return;
+
+	GPUPassScope pass {"GPU Particles"};
+
+	for (auto it = m_Buffers.begin(); it != m_Buffers.end(); ++it)
+	{
+		it.value().seen = false;
+	}
+
+	// update: every slot goes through the vertex shader once, the result lands in the other buffer
+	GLState::UseProgram(m_UpdateShader->programId);
+	glUniform1f(m_DeltaTimeLocation, m_DeltaTimes[render_.buffer]);
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	for (const auto& [entity, emitter] : frame)
+	{
+		if (emitter.capacity == 0)
+			continue;
+
+		auto& buffers = m_Buffers[entity];
+		if (buffers.capacity != emitter.capacity)
+		{
+			if (buffers.capacity != 0)
+				DeleteBuffers(buffers);
+
+			buffers = EmitterBuffers {};
+			CreateBuffers(buffers, emitter.capacity);
+		}
+
+		buffers.seen = true;
+		UploadSpawns(buffers, emitter.spawns);
+
+		const UInt32 target = 1 - buffers.source;
+		glUniform4f(
+			m_ColorSpeedLocation, emitter.colorSpeed.r, emitter.colorSpeed.g, emitter.colorSpeed.b,
+			emitter.colorSpeed.a);
+		GLState::BindVertexArray(buffers.updateVAO[buffers.source]);
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffers.particles[target]);
+
+		glBeginTransformFeedback(GL_POINTS);
+		glDrawArrays(GL_POINTS, 0, (GLsizei)buffers.capacity);
+		glEndTransformFeedback();
+
+		buffers.source = target;
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+	// draw: the buffer that was just written is read as per-instance data
+	GLState::UseProgram(m_DrawShader->programId);
+	for (const auto& [entity, emitter] : frame)
+	{
+		if (!emitter.visible || emitter.image == nullptr || emitter.capacity == 0)
+			continue;
+
+		const auto& buffers = m_Buffers[entity];
+		glUniform2f(m_SubTexSizeLocation, emitter.cutout.subSize.x, emitter.cutout.subSize.y);
+		glUniform2f(m_SubTexOriginLocation, emitter.cutout.subOrigin.x, emitter.cutout.subOrigin.y);
+		glUniform1f(m_DepthLocation, emitter.depth);
+
+		GLState::BindTexture(GL_TEXTURE_2D, emitter.image->TextureId());
+		GLState::BindVertexArray(buffers.drawVAO[buffers.source]);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)buffers.capacity);
+	}
+
+	// emitters whose entity is gone take their buffers with them
+	for (auto it = m_Buffers.begin(); it != m_Buffers.end();)
+	{
+		if (it->second.seen)
+		{
+			++it;
+			continue;
+		}
+
+		DeleteBuffers(it.value());
+		it = m_Buffers.erase(it);
+	}
+}
+
+void GPUParticleSystem::WindDown()
+{
+	Engine::Dispatcher().sink<RenderExtract>().disconnect<&GPUParticleSystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<Render>().disconnect<&GPUParticleSystem::OnRender>(this);
+
+	for (auto it = m_Buffers.begin(); it != m_Buffers.end(); ++it)
+	{
+		DeleteBuffers(it.value());
+	}
+	m_Buffers.clear();
+
+	glDeleteBuffers(1, &m_QuadVBO);
+}
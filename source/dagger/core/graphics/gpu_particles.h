@@ -0,0 +1,95 @@
+#pragma once
+
+#include "core/core.h"
+#include "core/graphics/shader.h"
+#include "core/graphics/sprite.h"
+#include "core/graphics/window.h"
+#include "core/system.h"
+
+using namespace dagger;
+
+// GPUParticle: the state of one particle, laid out exactly as it lives in the GPU buffers.
+// Speeds are per frame, lifetime is in seconds; a particle with no time left is dead and its slot free.
+struct GPUParticle
+{
+	Vector2 position {0, 0};
+	Vector2 velocity {0, 0};
+	Vector2 size {0, 0};
+	Vector2 sizeSpeed {0, 0};
+	ColorRGBA color {1.0f, 1.0f, 1.0f, 1.0f};
+	Float32 timeOfLiving {0.0f};
+};
+
+// GPUParticleEmitter: a particle effect that is simulated entirely on the GPU.
+// Gameplay only appends to `spawns`; they are handed to the GPU once and cleared at the end of the frame.
+// New particles overwrite the oldest slots once `capacity` particles are alive.
+struct GPUParticleEmitter
+{
+	Texture* image {nullptr};
+	SpriteCutoutData cutout {};
+	ColorRGBA colorSpeed {0.0f, 0.0f, 0.0f, 0.0f};
+	Float32 depth {0.0f};
+	UInt32 capacity {1024};
+	Bool visible {true};
+
+	Sequence<GPUParticle> spawns;
+};
+
+// GPUParticleSystem: advances every GPUParticleEmitter with a transform feedback pass, then draws it instanced.
+// Emitters are drawn after sprites, so they end up on top of them.
+class GPUParticleSystem
+	: public System
+	, public Subscriber<RenderExtract, Render>
+{
+	// render-side state of one emitter: particles ping-pong between the two buffers every frame
+	struct EmitterBuffers
+	{
+		StaticArray<UInt32, 2> particles {};
+		StaticArray<UInt32, 2> updateVAO {};
+		StaticArray<UInt32, 2> drawVAO {};
+		UInt32 capacity {0};
+		UInt32 source {0};
+		UInt32 head {0};
+		Bool seen {false};
+	};
+
+	struct EmitterFrame
+	{
+		Entity entity;
+		GPUParticleEmitter emitter;
+	};
+
+	const Float32 m_VerticesAndTexCoords[24] = {-0.5f, -0.5f, 0.0f, 0.0f, -0.5f, 0.5f,	0.0f, 1.0f,
+												0.5f,  0.5f,  1.0f, 1.0f, 0.5f,	 -0.5f, 1.0f, 0.0f,
+												-0.5f, -0.5f, 0.0f, 0.0f, 0.5f,	 0.5f,	1.0f, 1.0f};
+
+	UInt32 m_QuadVBO {0};
+	ViewPtr<Shader> m_UpdateShader {nullptr};
+	ViewPtr<Shader> m_DrawShader {nullptr};
+
+	GLint m_ColorSpeedLocation {-1};
+	GLint m_DeltaTimeLocation {-1};
+	GLint m_SubTexSizeLocation {-1};
+	GLint m_SubTexOriginLocation {-1};
+	GLint m_DepthLocation {-1};
+
+	StaticArray<Sequence<EmitterFrame>, WindowSystem::s_FrameBufferCount> m_Frames;
+	StaticArray<Float32, WindowSystem::s_FrameBufferCount> m_DeltaTimes {};
+	Map<Entity, EmitterBuffers> m_Buffers;
+
+	void OnRenderExtract(RenderExtract extract_);
+	void OnRender(Render render_);
+
+	void CreateBuffers(EmitterBuffers& buffers_, UInt32 capacity_);
+	void DeleteBuffers(EmitterBuffers& buffers_);
+	void UploadSpawns(EmitterBuffers& buffers_, const Sequence<GPUParticle>& spawns_);
+
+public:
+	inline String SystemName() const override
+	{
+		return "GPU Particle System";
+	}
+
+	void SpinUp() override;
+	void WindDown() override;
+};
@@ -0,0 +1,127 @@
+#include "gpu_timer.h"
+
+#include "core/engine.h"
+
+using namespace dagger;
+
+GPUTimer::Pass& GPUTimer::FindOrCreatePass(const String& name_)
+{
+	for (auto& pass : m_Passes)
+	{
+		if (pass.name == name_)
+			return pass;
+	}
+
+	auto& pass = m_Passes.emplace_back();
+	pass.name = name_;
+	glGenQueries((GLsizei)s_QueryLatency, pass.queries.data());
+	return pass;
+}
+
+void GPUTimer::BeginFrame()
+{
+	m_FrameIndex = (m_FrameIndex + 1) % s_QueryLatency;
+
+	if (m_RestartRequested.exchange(false))
+	{
+		for (auto& pass : m_Passes)
+		{
+			pass.totalMilliseconds = 0.0;
+			pass.samples = 0;
+		}
+	}
+
+	for (auto& pass : m_Passes)
+	{
+		for (UInt32 i = 0; i < s_QueryLatency; i++)
+		{
+			if (!pass.pending[i])
+				continue;
+
+			GLint available = 0;
+			glGetQueryObjectiv(pass.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+
+			// never wait on the GPU here, a result that is not ready will be picked up next frame
+			if (available == 0)
+				continue;
+
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(pass.queries[i], GL_QUERY_RESULT, &nanoseconds);
+			pass.pending[i] = false;
+
+			pass.totalMilliseconds += (Float64)nanoseconds / 1000000.0;
+			pass.samples++;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock {m_TimingsMutex};
+	m_Timings.resize(m_Passes.size());
+	for (UInt32 i = 0; i < m_Passes.size(); i++)
+	{
+		const auto& pass = m_Passes[i];
+		const Float64 average = pass.samples == 0 ? 0.0 : pass.totalMilliseconds / pass.samples;
+		m_Timings[i] = GPUPassTiming {pass.name, (Float32)average};
+	}
+}
+
+void GPUTimer::BeginPass(const String& name_)
+{
+	// GL_TIME_ELAPSED queries cannot nest
+	assert(m_ActivePass < 0);
+
+	auto& pass = FindOrCreatePass(name_);
+
+	// all the queries of this pass are still in flight, so skip timing it this frame rather than stall
+	if (pass.pending[m_FrameIndex])
+		return;
+
+	glBeginQuery(GL_TIME_ELAPSED, pass.queries[m_FrameIndex]);
+	pass.pending[m_FrameIndex] = true;
+	m_ActivePass = (SInt32)(&pass - m_Passes.data());
+}
+
+void GPUTimer::EndPass()
+{
+	if (m_ActivePass < 0)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_ActivePass = -1;
+}
+
+Sequence<GPUPassTiming> GPUTimer::Timings() const
+{
+	std::lock_guard<std::mutex> lock {m_TimingsMutex};
+	return m_Timings;
+}
+
+void GPUTimer::Restart()
+{
+	m_RestartRequested = true;
+}
+
+void GPUTimer::Release()
+{
+	for (auto& pass : m_Passes)
+	{
+		glDeleteQueries((GLsizei)s_QueryLatency, pass.queries.data());
+	}
+
+	m_Passes.clear();
+	m_ActivePass = -1;
+
+	std::lock_guard<std::mutex> lock {m_TimingsMutex};
+	m_Timings.clear();
+}
+
+GPUPassScope::GPUPassScope(const String& name_) : m_Timer {Engine::GetDefaultResource<GPUTimer>()}
+{
+	if (m_Timer != nullptr)
+		m_Timer->BeginPass(name_);
+}
+
+GPUPassScope::~GPUPassScope()
+{
+	if (m_Timer != nullptr)
+		m_Timer->EndPass();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <mutex>
+
+using namespace dagger;
+
+// GPUPassTiming: how long the GPU spent on a named render pass, averaged over the frames read back since the last
+// GPUTimer::Restart (once a second with the diagnostics on).
+struct GPUPassTiming
+{
+	String name;
+	Float32 milliseconds {0.0f};
+};
+
+// GPUTimer: wraps render passes in GL_TIME_ELAPSED queries.
+// Every pass keeps a small ring of queries so results are read a few frames late instead of stalling the pipeline.
+// All GL calls happen on whichever thread owns the context; Timings() may be called from anywhere.
+class GPUTimer
+{
+public:
+	constexpr static UInt32 s_QueryLatency = 4;
+
+private:
+	struct Pass
+	{
+		String name;
+		StaticArray<GLuint, s_QueryLatency> queries {};
+		StaticArray<Bool, s_QueryLatency> pending {};
+		Float64 totalMilliseconds {0.0};
+		UInt64 samples {0};
+	};
+
+	Sequence<Pass> m_Passes;
+	UInt32 m_FrameIndex {0};
+	SInt32 m_ActivePass {-1};
+
+	std::atomic<Bool> m_RestartRequested {false};
+
+	mutable std::mutex m_TimingsMutex;
+	Sequence<GPUPassTiming> m_Timings;
+
+	Pass& FindOrCreatePass(const String& name_);
+
+public:
+	void BeginFrame();
+	void BeginPass(const String& name_);
+	void EndPass();
+
+	Sequence<GPUPassTiming> Timings() const;
+
+	// starts the averages over from the next frame read back; safe to call from any thread
+	void Restart();
+
+	void Release();
+};
+
+// GPUPassScope: times everything issued to the GPU until the end of the enclosing scope.
+class GPUPassScope
+{
+	GPUTimer* m_Timer;
+
+public:
+	explicit GPUPassScope(const String& name_);
+	~GPUPassScope();
+
+	GPUPassScope(const GPUPassScope&) = delete;
+	GPUPassScope& operator=(const GPUPassScope&) = delete;
+};
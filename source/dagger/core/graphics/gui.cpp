@@ -1,7 +1,8 @@
-
 #include "gui.h"
 
 #include "core/engine.h"
+#include "gl_state.h"
+#include "gpu_timer.h"
 
 #include <imgui/backends/imgui_impl_glfw.h>
 #include <imgui/backends/imgui_impl_opengl3.h>
@@ -21,8 +22,12 @@ void GUISystem::SpinUp()
 	ImGui_ImplOpenGL3_Init();
 	ImGui_ImplGlfw_InitForOpenGL(renderConfig->window, true);
 
+	// created here while the context is still ours, so NewFrame never touches GL from the main thread
+	ImGui_ImplOpenGL3_CreateDeviceObjects();
+
 	Engine::Dispatcher().sink<PreRender>().connect<&GUISystem::OnPreRender>(this);
-	Engine::Dispatcher().sink<ToolRender>().connect<&GUISystem::OnToolRender>(this);
+	Engine::Dispatcher().sink<RenderExtract>().connect<&GUISystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<ToolRender>().connect<&GUISystem::OnToolRender>(this);
 }
 
 void GUISystem::OnPreRender()
@@ -34,14 +39,82 @@ void GUISystem::OnPreRender()
 	ImGui::Render();
 }
 
-void GUISystem::OnToolRender()
+void GUISystem::ReleaseFrame(GUIFrame& frame_)
+{
+	for (auto* list : frame_.drawLists)
+	{
+		IM_DELETE(list);
+	}
+
+	frame_.drawLists.clear();
+	frame_.drawData.Clear();
+	frame_.toDraw = nullptr;
+}
+
+void GUISystem::OnRenderExtract(RenderExtract extract_)
+{
+	auto& frame = m_Frames[extract_.buffer];
+	ReleaseFrame(frame);
+
+	auto* source = ImGui::GetDrawData();
+	if (source == nullptr || !source->Valid)
+		return;
+
+	if (!Engine::GetDefaultResource<RenderConfig>()->pipelined)
+	{
+		frame.toDraw = source;
+		return;
+	}
+
+	for (int i = 0; i < source->CmdListsCount; i++)
+	{
+		frame.drawLists.push_back(source->CmdLists[i]->CloneOutput());
+	}
+
+	auto& copy = frame.drawData;
+	copy.Valid = true;
+	copy.CmdListsCount = source->CmdListsCount;
+	copy.TotalIdxCount = source->TotalIdxCount;
+	copy.TotalVtxCount = source->TotalVtxCount;
+	copy.DisplayPos = source->DisplayPos;
+	copy.DisplaySize = source->DisplaySize;
+	copy.FramebufferScale = source->FramebufferScale;
+
+#if IMGUI_VERSION_NUM >= 18973
+	for (auto* list : frame.drawLists)
+	{
+		copy.CmdLists.push_back(list);
+	}
+#else
+	copy.CmdLists = frame.drawLists.data();
+#endif // IMGUI_VERSION_NUM >= 18973
+
+	frame.toDraw = &copy;
+}
+
+void GUISystem::OnToolRender(ToolRender render_)
 {
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	auto& frame = m_Frames[render_.buffer];
+	if (frame.toDraw == nullptr)
+		return;
+
+	GPUPassScope pass {"ImGui"};
+	ImGui_ImplOpenGL3_RenderDrawData(frame.toDraw);
+
+	// the backend binds its own objects without going through GLState
+	GLState::Invalidate();
 }
 
 void GUISystem::WindDown()
 {
 	Engine::Dispatcher().sink<PreRender>().disconnect<&GUISystem::OnPreRender>(this);
-	Engine::Dispatcher().sink<ToolRender>().disconnect<&GUISystem::OnToolRender>(this);
+	Engine::Dispatcher().sink<RenderExtract>().disconnect<&GUISystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<ToolRender>().disconnect<&GUISystem::OnToolRender>(this);
+
+	for (auto& frame : m_Frames)
+	{
+		ReleaseFrame(frame);
+	}
+
 	ImGui::DestroyContext();
-}
\ No newline at end of file
+}
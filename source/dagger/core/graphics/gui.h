@@ -4,15 +4,31 @@
 #include "core/system.h"
 #include "window.h"
 
+#include <imgui/imgui.h>
+
 using namespace dagger;
 
+// GUIFrame: ImGui draw data as it was at the end of simulation.
+// When rendering is pipelined the draw lists are cloned, since ImGui rebuilds its own while the frame is drawn.
+struct GUIFrame
+{
+	ImDrawData drawData;
+	Sequence<ImDrawList*> drawLists;
+	ImDrawData* toDraw {nullptr};
+};
+
 class GUISystem
 	: public System
-	, public Subscriber<PreRender, ToolRender>
+	, public Subscriber<PreRender, RenderExtract, ToolRender>
 	, public Publisher<GUIRender>
 {
+	StaticArray<GUIFrame, WindowSystem::s_FrameBufferCount> m_Frames;
+
 	void OnPreRender();
-	void OnToolRender();
+	void OnRenderExtract(RenderExtract extract_);
+	void OnToolRender(ToolRender render_);
+
+	void ReleaseFrame(GUIFrame& frame_);
 
 public:
 	inline String SystemName() const override
@@ -22,4 +38,4 @@ public:
 
 	void SpinUp() override;
 	void WindDown() override;
-};
\ No newline at end of file
+};
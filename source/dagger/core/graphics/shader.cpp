@@ -3,23 +3,131 @@
 #include "core/engine.h"
 #include "core/files.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <fstream>
 
 using namespace dagger;
 
+// Written in front of every cached program binary.
+struct ProgramCacheHeader
+{
+	constexpr static UInt32 s_Magic = 0x44475042; // "DGPB"
+
+	UInt32 magic;
+	UInt64 key;
+	GLenum format;
+	GLsizei length;
+};
+
+static void HashInto(UInt64& hash_, const void* data_, size_t length_)
+{
+	// FNV-1a, chosen because the result has to stay the same between runs and builds
+	const auto* bytes = static_cast<const UInt8*>(data_);
+	for (size_t i = 0; i < length_; i++)
+	{
+		hash_ ^= bytes[i];
+		hash_ *= 0x100000001B3ull;
+	}
+}
+
+static void HashInto(UInt64& hash_, const char* string_)
+{
+	if (string_ != nullptr)
+		HashInto(hash_, string_, strlen(string_));
+}
+
+static FilePath ProgramCacheFile(const String& name_)
+{
+	return FilePath {Shader::s_ProgramCachePath} / fmt::format("{}.bin", name_);
+}
+
+void Shader::BindUniformBlocks()
+{
+	// block bindings are not part of a program binary, so this runs after either kind of load
+	GLuint blockIndex = glGetUniformBlockIndex(programId, s_FrameConstantsBlockName);
+	if (blockIndex != GL_INVALID_INDEX)
+		glUniformBlockBinding(programId, blockIndex, s_FrameConstantsBinding);
+}
+
+Bool Shader::LoadFromProgramCache(UInt64 key_)
+{
+	if (!GLAD_GL_ARB_get_program_binary)
+		return false;
+
+	std::ifstream input {ProgramCacheFile(shaderName), std::ios::binary};
+	if (!input.is_open())
+		return false;
+
+	ProgramCacheHeader header {};
+	input.read(reinterpret_cast<char*>(&header), sizeof(ProgramCacheHeader));
+
+	// different sources or a different driver: the entry is stale and will be overwritten
+	if (!input || header.magic != ProgramCacheHeader::s_Magic || header.key != key_ || header.length <= 0)
+		return false;
+
+	Sequence<char> binary(header.length);
+	input.read(binary.data(), header.length);
+	if (!input)
+		return false;
+
+	glProgramBinary(programId, header.format, binary.data(), header.length);
+
+	GLint success;
+	glGetProgramiv(programId, GL_LINK_STATUS, &success);
+	if (success == 0)
+	{
+		Logger::warn("Cached binary for shader '{}' was rejected by the driver, recompiling", shaderName);
+
+		// start from a clean program object, the failed load leaves this one unlinked
+		glDeleteProgram(programId);
+		programId = glCreateProgram();
+		return false;
+	}
+
+	return true;
+}
+
+void Shader::StoreInProgramCache(UInt64 key_)
+{
+	if (!GLAD_GL_ARB_get_program_binary)
+		return;
+
+	GLint length = 0;
+	glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	ProgramCacheHeader header {ProgramCacheHeader::s_Magic, key_, 0, 0};
+	Sequence<char> binary(length);
+	glGetProgramBinary(programId, length, &header.length, &header.format, binary.data());
+	if (header.length <= 0)
+		return;
+
+	std::error_code error;
+	Files::create_directories(s_ProgramCachePath, error);
+
+	std::ofstream output {ProgramCacheFile(shaderName), std::ios::binary | std::ios::trunc};
+	if (error || !output.is_open())
+	{
+		Logger::warn("Couldn't write the program cache for shader '{}'", shaderName);
+		return;
+	}
+
+	output.write(reinterpret_cast<const char*>(&header), sizeof(ProgramCacheHeader));
+	output.write(binary.data(), header.length);
+}
+
 Shader::Shader(ShaderConfig config_) : programId {0}, shaderName {config_.name}
 {
 	Logger::info("Constructing shader program '{}'", config_.name);
 
-	Sequence<UInt32> shaderIds;
-
-	programId = glCreateProgram();
+	Sequence<Pair<EShaderStage, String>> sources;
 
 	for (auto [stage, path] : config_.paths)
 	{
 		Logger::info("Loading {}'s {}...", config_.name, Shader::s_ShaderStageNames[stage]);
-		UInt32 id = glCreateShader(Shader::s_ShaderStageHandles[stage]);
-
 		String source = ReadFromFile(path);
 
 		if (source.empty())
@@ -28,6 +136,46 @@ Shader::Shader(ShaderConfig config_) : programId {0}, shaderName {config_.name}
 			return;
 		}
 
+		sources.emplace_back(stage, std::move(source));
+	}
+
+	// map order isn't stable, the cache key has to be
+	std::sort(sources.begin(), sources.end(), [](const auto& a_, const auto& b_) { return a_.first < b_.first; });
+
+	UInt64 cacheKey = 0xCBF29CE484222325ull;
+	for (const auto& [stage, source] : sources)
+	{
+		HashInto(cacheKey, &stage, sizeof(EShaderStage));
+		HashInto(cacheKey, source.c_str());
+	}
+	for (const auto& varying : config_.feedbackVaryings)
+	{
+		HashInto(cacheKey, varying.c_str());
+	}
+	HashInto(cacheKey, reinterpret_cast<const char*>(glGetString(GL_VENDOR)));
+	HashInto(cacheKey, reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+	HashInto(cacheKey, reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+	programId = glCreateProgram();
+
+	if (LoadFromProgramCache(cacheKey))
+	{
+		Logger::info("Loaded shader '{}' from the program cache", config_.name);
+		BindUniformBlocks();
+
+		if (!s_FirstLoadedShader)
+		{
+			s_FirstLoadedShader.Reset(this);
+		}
+		return;
+	}
+
+	Sequence<UInt32> shaderIds;
+
+	for (const auto& [stage, source] : sources)
+	{
+		UInt32 id = glCreateShader(Shader::s_ShaderStageHandles[stage]);
+
 		{
 			const auto* sourceCode = source.c_str();
 			glShaderSource(id, 1, &sourceCode, nullptr);
@@ -54,6 +202,19 @@ Shader::Shader(ShaderConfig config_) : programId {0}, shaderName {config_.name}
 		}
 	}
 
+	if (!config_.feedbackVaryings.empty())
+	{
+		Sequence<const char*> varyings;
+		for (const auto& varying : config_.feedbackVaryings)
+		{
+			varyings.push_back(varying.c_str());
+		}
+		glTransformFeedbackVaryings(programId, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+	}
+
+	if (GLAD_GL_ARB_get_program_binary)
+		glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	glLinkProgram(programId);
 
 	{
@@ -79,6 +240,9 @@ Shader::Shader(ShaderConfig config_) : programId {0}, shaderName {config_.name}
 
 	assert(programId != 0);
 
+	StoreInProgramCache(cacheKey);
+	BindUniformBlocks();
+
 	if (!s_FirstLoadedShader)
 	{
 		s_FirstLoadedShader.Reset(this);
@@ -91,4 +255,4 @@ Shader::~Shader()
 		glDeleteProgram(programId);
 
 	Logger::info("Successfully destroyed shader '{}'", shaderName);
-}
\ No newline at end of file
+}
@@ -19,6 +19,8 @@ struct ShaderConfig
 	String name {};
 	EShaderStage stages {EShaderStage::None};
 	Map<EShaderStage, String> paths {};
+	// vertex outputs captured into a buffer with transform feedback, in buffer order
+	Sequence<String> feedbackVaryings {};
 };
 
 struct Shader
@@ -32,9 +34,9 @@ struct Shader
 		{EShaderStage::Fragment, GL_FRAGMENT_SHADER},
 	};
 
-	inline static const char* s_ViewportMatrixName {"u_Viewport"};
-	inline static const char* s_ProjectionMatrixName {"u_Projection"};
-	inline static const char* s_CameraMatrixName {"u_Camera"};
+	// Every program that declares this uniform block gets it bound to the same slot, filled once per frame.
+	inline static const char* s_FrameConstantsBlockName {"FrameConstants"};
+	constexpr static UInt32 s_FrameConstantsBinding = 0;
 
 	inline static Map<String, EShaderStage> s_ShaderStageIndex = {
 		{"vertex-shader", EShaderStage::Vertex},
@@ -46,6 +48,9 @@ struct Shader
 		{EShaderStage::Fragment, "Fragment Shader"},
 	};
 
+	// Linked programs are kept here as driver binaries, so later launches can skip compiling and linking.
+	inline static const char* s_ProgramCachePath {"cache/shaders"};
+
 	UInt32 programId;
 	String shaderName;
 
@@ -53,4 +58,9 @@ struct Shader
 
 	Shader(ShaderConfig config_);
 	~Shader();
+
+private:
+	void BindUniformBlocks();
+	Bool LoadFromProgramCache(UInt64 key_);
+	void StoreInProgramCache(UInt64 key_);
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "core/engine.h"
 #include "core/filesystem.h"
+#include "core/graphics/gl_state.h"
 
 #include <regex>
 #include <string>
@@ -12,8 +13,7 @@ void ShaderSystem::Use(String name_)
 {
 	auto* shader = Engine::Res<Shader>()[name_];
 	assert(shader != nullptr);
-	glUseProgram(shader->programId);
-	Engine::Dispatcher().trigger<ShaderChangeRequest>(ShaderChangeRequest(shader));
+	GLState::UseProgram(shader->programId);
 }
 
 ViewPtr<Shader> ShaderSystem::Get(String name_)
@@ -75,6 +75,12 @@ void ShaderSystem::OnLoadAsset(AssetLoadRequest<Shader> request_)
 		}
 
 		config.paths = stageLoader;
+
+		if (json.contains("feedback-varyings"))
+		{
+			config.feedbackVaryings = json["feedback-varyings"].get<Sequence<String>>();
+		}
+
 		auto* shader = new Shader(config);
 		Engine::Res<Shader>()[config.name] = shader;
 	}
@@ -93,6 +99,13 @@ void ShaderSystem::SpinUp()
 		}
 	}
 
+	// directory order is arbitrary, and the particle programs can't draw sprites, so the default is pinned here
+	auto& shaders = Engine::Res<Shader>();
+	if (shaders.contains("standard"))
+	{
+		Shader::s_FirstLoadedShader.Reset(shaders["standard"]);
+	}
+
 	Engine::Dispatcher().trigger<AssetLoadFinished<Shader>>(AssetLoadFinished<Shader> {});
 }
 
@@ -11,19 +11,6 @@
 
 using namespace dagger;
 
-class ShaderChangeRequest
-{
-	ViewPtr<Shader> m_Shader;
-
-public:
-	explicit ShaderChangeRequest(ViewPtr<Shader> shader_) : m_Shader {shader_} { }
-
-	ViewPtr<Shader> GetShader()
-	{
-		return m_Shader;
-	};
-};
-
 class ShaderSystem
 	: public System
 	, public Subscriber<AssetLoadRequest<Shader>>
@@ -50,6 +50,16 @@ namespace dagger
 		Bool visible {true};
 	};
 
+	// SpriteBatch: quads that share one texture and shader, drawn with a single instanced call and no entity each.
+	// The whole batch is ordered by the depth of its first instance.
+	struct SpriteBatch
+	{
+		Texture* image {nullptr};
+		ViewPtr<Shader> shader {Shader::s_FirstLoadedShader};
+		Sequence<SpriteData> instances;
+		Bool visible {true};
+	};
+
 	struct SpriteFrame
 	{
 		ViewPtr<Texture> texture;
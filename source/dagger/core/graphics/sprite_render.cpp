@@ -1,6 +1,8 @@
 #include "sprite_render.h"
 
 #include "core/engine.h"
+#include "gl_state.h"
+#include "gpu_timer.h"
 #include "sprite.h"
 #include "texture.h"
 #include "textures.h"
@@ -15,10 +17,10 @@ using namespace dagger;
 void SpriteRenderSystem::SpinUp()
 {
 	glGenVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
+	GLState::BindVertexArray(m_VAO);
 
 	glGenBuffers(1, &m_StaticMeshVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(m_VerticesAndTexCoords), m_VerticesAndTexCoords, GL_STATIC_DRAW);
 
 	// attribute #0: vertex position
@@ -32,7 +34,7 @@ void SpriteRenderSystem::SpinUp()
 	const GLsizei dataSize = sizeof(SpriteData);
 
 	glGenBuffers(1, &m_InstanceQuadInfoVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
 	glBufferData(GL_ARRAY_BUFFER, s_BufferSize, nullptr, GL_STREAM_DRAW);
 
 	const StaticArray<Pair<UInt32, UInt32>, 9> sizesAndStrides = {
@@ -57,10 +59,10 @@ void SpriteRenderSystem::SpinUp()
 		glVertexAttribDivisor(index, 1);
 	}
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 
 	glEnable(GL_TEXTURE_2D);
-	glActiveTexture(GL_TEXTURE0);
+	GLState::ActiveTexture(GL_TEXTURE0);
 
 	Engine::Dispatcher().sink<AssetLoadRequest<SpriteFrame>>().connect<&SpriteRenderSystem::OnRequestSpritesheet>(this);
 
@@ -71,7 +73,8 @@ void SpriteRenderSystem::SpinUp()
 				AssetLoadRequest<SpriteFrame> {entry.path().string()});
 	}
 
-	Engine::Dispatcher().sink<Render>().connect<&SpriteRenderSystem::OnRender>(this);
+	Engine::Dispatcher().sink<RenderExtract>().connect<&SpriteRenderSystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<Render>().connect<&SpriteRenderSystem::OnRender>(this);
 }
 
 void SpriteRenderSystem::OnRequestSpritesheet(AssetLoadRequest<SpriteFrame> request_)
@@ -156,7 +159,21 @@ void SpriteRenderSystem::OnRequestSpritesheet(AssetLoadRequest<SpriteFrame> requ
 	}
 }
 
-void SpriteRenderSystem::OnRender()
+void SpriteRenderSystem::OnRenderExtract(RenderExtract extract_)
+{
+	auto& frame = m_Frames[extract_.buffer];
+
+	// only copy here, sorting and uploading happen on the render side
+	const auto& sprites = Engine::Registry().view<Sprite>();
+	frame.sprites.assign(sprites.storage().begin(), sprites.storage().end());
+
+	// copy-assigning into the existing batches keeps their instance buffers allocated between frames
+	const auto& batches = Engine::Registry().view<SpriteBatch>();
+	frame.batches.resize(batches.storage().size());
+	std::copy(batches.storage().begin(), batches.storage().end(), frame.batches.begin());
+}
+
+void SpriteRenderSystem::OnRender(Render render_)
 {
 	static auto sortSprites = [](const Sprite& a_, const Sprite& b_)
 	{
@@ -193,17 +210,19 @@ void SpriteRenderSystem::OnRender()
 		}
 	};
 
-	glBindVertexArray(m_VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
+	GPUPassScope pass {"Sprites"};
 
-	// get a view of all the entities and their sprite components
-	ViewPtr<Texture> prevTexture {nullptr};
-	ViewPtr<Shader> prevShader {nullptr};
+	GLState::BindVertexArray(m_VAO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
 
-	const auto& view = Engine::Registry().view<Sprite>();
-	Sequence<Sprite> sprites {view.storage().begin(), view.storage().end()};
+	auto& frame = m_Frames[render_.buffer];
+	auto& sprites = frame.sprites;
 	std::sort(sprites.begin(), sprites.end(), sortSprites);
-	Sequence<SpriteData> currentRender {};
+
+	// sprites become instance data cut into runs of equal depth, shader and texture,
+	// batches already are instance data and make one run each
+	m_Instances.clear();
+	m_Runs.clear();
 
 	auto ptr = sprites.begin();
 	// Skip invisible sprites
@@ -211,57 +230,78 @@ void SpriteRenderSystem::OnRender()
 	{
 		ptr++;
 	}
-	// Draw all others
-	while (ptr != sprites.end())
+
+	for (; ptr != sprites.end(); ptr++)
 	{
-		if (prevShader != ptr->shader)
+		assert(ptr->image != nullptr);
+		if (ptr->image == nullptr)
+			continue;
+
+		const UInt32 z = ptr->position.z;
+		if (m_Runs.empty() || m_Runs.back().z != z || m_Runs.back().shader != ptr->shader ||
+			m_Runs.back().image != ptr->image)
 		{
-			prevShader = ptr->shader;
-			glUseProgram(prevShader->programId);
-			Engine::Dispatcher().trigger<ShaderChangeRequest>(ShaderChangeRequest(prevShader));
+			m_Runs.push_back(SpriteRun {z, ptr->shader, ptr->image, nullptr, m_Instances.size(), 0});
 		}
 
-		assert(ptr->image != nullptr);
-		while (ptr != sprites.end() && ptr->image == nullptr)
-			ptr++;
-		if (ptr == sprites.end())
-			break;
+		// look at the definition of SpriteData if you're wondering why the cast.
+		// we only need some fields, to optimize on data transfer.
+		m_Instances.push_back((SpriteData)*ptr);
+		m_Runs.back().count++;
+	}
 
-		prevTexture = ptr->image;
+	for (const auto& batch : frame.batches)
+	{
+		if (!batch.visible || batch.image == nullptr || batch.instances.empty())
+			continue;
 
-		while (ptr != sprites.end() && prevTexture == ptr->image)
-		{
-			// look at the definition of SpriteData if you're wondering why the cast.
-			// we only need some fields, to optimize on data transfer.
-			currentRender.push_back((SpriteData)*ptr);
-			ptr++;
-		}
+		const UInt32 z = batch.instances.front().position.z;
+		m_Runs.push_back(SpriteRun {z, batch.shader, batch.image, batch.instances.data(), 0, batch.instances.size()});
+	}
 
-		const UInt32 renderSize = sizeof(SpriteData) * currentRender.size();
+	// sprite runs are already in order, a stable sort only slots the batches in between them
+	std::stable_sort(
+		m_Runs.begin(), m_Runs.end(), [](const SpriteRun& a_, const SpriteRun& b_) { return a_.z > b_.z; });
 
-		m_Data = reinterpret_cast<float*>(
-			glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof(Sprite) * currentRender.size(), GL_MAP_WRITE_BIT));
+	for (const auto& run : m_Runs)
+	{
+		GLState::UseProgram(run.shader->programId);
+		GLState::BindTexture(GL_TEXTURE_2D, run.image->TextureId());
+		DrawInstances(run.data != nullptr ? run.data : m_Instances.data() + run.offset, run.count);
+	}
+}
 
-		memcpy(m_Data, &(*currentRender.begin()), renderSize);
+void SpriteRenderSystem::DrawInstances(const SpriteData* data_, UInt64 count_)
+{
+	constexpr UInt64 maxInstancesPerDraw = s_BufferSize / sizeof(SpriteData);
+
+	while (count_ > 0)
+	{
+		const UInt64 count = std::min(count_, maxInstancesPerDraw);
+		const UInt64 renderSize = sizeof(SpriteData) * count;
+
+		m_Data = reinterpret_cast<float*>(glMapBufferRange(
+			GL_ARRAY_BUFFER, 0, renderSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+
+		memcpy(m_Data, data_, renderSize);
 		glUnmapBuffer(GL_ARRAY_BUFFER);
 
-		glBindTexture(GL_TEXTURE_2D, prevTexture->TextureId());
-		glDrawArraysInstanced(GL_TRIANGLES, 0, s_VertexCount, (GLsizei)currentRender.size());
-		currentRender.clear();
-	}
+		glDrawArraysInstanced(GL_TRIANGLES, 0, s_VertexCount, (GLsizei)count);
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+		data_ += count;
+		count_ -= count;
+	}
 }
 
 void SpriteRenderSystem::WindDown()
 {
-	glBindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
 	glUnmapBuffer(GL_ARRAY_BUFFER);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 	glDeleteBuffers(1, &m_StaticMeshVBO);
 
 	glDeleteVertexArrays(1, &m_VAO);
 
-	Engine::Dispatcher().sink<Render>().disconnect<&SpriteRenderSystem::OnRender>(this);
+	Engine::Dispatcher().sink<RenderExtract>().disconnect<&SpriteRenderSystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<Render>().disconnect<&SpriteRenderSystem::OnRender>(this);
 }
@@ -14,9 +14,27 @@
 
 using namespace dagger;
 
+// SpriteRenderFrame: what was extracted for one frame, see RenderExtract.
+struct SpriteRenderFrame
+{
+	Sequence<Sprite> sprites;
+	Sequence<SpriteBatch> batches;
+};
+
+// SpriteRun: consecutive instances drawn with one shader and texture in a single call.
+struct SpriteRun
+{
+	UInt32 z;
+	ViewPtr<Shader> shader;
+	Texture* image;
+	const SpriteData* data;
+	UInt64 offset;
+	UInt64 count;
+};
+
 class SpriteRenderSystem
 	: public System
-	, public Subscriber<Render, ShaderChangeRequest>
+	, public Subscriber<RenderExtract, Render>
 {
 	const Float32 m_VerticesAndTexCoords[24] = {-0.5f, -0.5f, 0.0f, 0.0f, -0.5f, 0.5f,	0.0f, 1.0f,
 												0.5f,  0.5f,  1.0f, 1.0f, 0.5f,	 -0.5f, 1.0f, 0.0f,
@@ -29,7 +47,14 @@ class SpriteRenderSystem
 
 	UInt8 m_Index = 0;
 
-	void OnRender();
+	StaticArray<SpriteRenderFrame, WindowSystem::s_FrameBufferCount> m_Frames;
+	Sequence<SpriteData> m_Instances;
+	Sequence<SpriteRun> m_Runs;
+
+	void OnRenderExtract(RenderExtract extract_);
+	void OnRender(Render render_);
+
+	void DrawInstances(const SpriteData* data_, UInt64 count_);
 
 public:
 	inline String SystemName() const override
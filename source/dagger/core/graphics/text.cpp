@@ -2,84 +2,360 @@
 
 #include "core/core.h"
 #include "core/engine.h"
+#include "core/filesystem.h"
+#include "core/graphics/distance_field.h"
+#include "core/graphics/gl_state.h"
+#include "core/graphics/shaders.h"
 #include "core/graphics/sprite.h"
 
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+
 using namespace dagger;
 
+Font* Font::Get(const String& name_)
+{
+	auto& fonts = Engine::Res<Font>();
+	if (fonts.contains(name_))
+		return fonts[name_];
+
+	assert(Engine::Res<Texture>().contains(fmt::format("spritesheets:{}", name_)));
+
+	auto& sheets = Engine::Res<SpriteFrame>();
+	auto* font = new Font();
+
+	for (UInt32 code = 0; code < s_GlyphCount; code++)
+	{
+		auto frameName = fmt::format("spritesheets:{}:{}", name_, code);
+		if (!sheets.contains(frameName))
+			continue;
+
+		auto* frame = sheets[frameName];
+		font->texture = frame->texture.Get();
+		font->glyphs[code] = frame->frame;
+		font->advances[code] = frame->frame.size;
+		font->present[code] = true;
+	}
+
+	fonts[name_] = font;
+	return font;
+}
+
+Bool TextProperties::operator==(const TextProperties& other_) const
+{
+	return font == other_.font && message == other_.message && color == other_.color &&
+		   direction == other_.direction && alignment == other_.alignment && scale == other_.scale &&
+		   spacing == other_.spacing && position == other_.position && ui == other_.ui;
+}
+
+Bool TextProperties::operator!=(const TextProperties& other_) const
+{
+	return !(*this == other_);
+}
+
 void Text::Set(String font_, String message_, Vector3 pos_, Bool ui_)
 {
 	font = font_;
+	message = message_;
 	position = pos_;
+	ui = ui_;
+}
 
-	auto& registry = Engine::Registry();
+void Text::Clear()
+{
+	message.clear();
+}
 
-	assert(Engine::Res<Texture>().contains(fmt::format("spritesheets:{}", font_)));
+void TextSystem::Layout(const Text& text_, SpriteBatch& batch_)
+{
+	batch_.instances.clear();
 
-	Clear();
+	if (text_.message.empty())
+		return;
 
-	SInt32 currentPosition;
-	if (direction == ETextDirection::RIGHT)
-		currentPosition = position.x;
-	else if (direction == ETextDirection::DOWN)
-		currentPosition = position.y;
+	auto* font = Font::Get(text_.font);
+	batch_.image = font->texture;
+	batch_.shader = font->shader ? font->shader : Shader::s_FirstLoadedShader;
 
-	auto& sheets = Engine::Res<SpriteFrame>();
-
-	Map<UInt32, SpriteFrame*> cache;
 	UInt32 fullStringWidth = 0;
-	for (char letter : message_)
+	for (char letter : text_.message)
 	{
-		cache[letter] = sheets[fmt::format("spritesheets:{}:{}", font, (int)letter)];
-		if (direction == ETextDirection::RIGHT)
-			fullStringWidth += cache[letter]->frame.size.x * scale.x * spacing;
-		else if (direction == ETextDirection::DOWN)
-			fullStringWidth += cache[letter]->frame.size.y * scale.y * spacing;
+		UInt32 code = (UInt8)letter;
+		if (code >= Font::s_GlyphCount || !font->present[code])
+			continue;
+
+		const auto& advance = font->advances[code];
+		if (text_.direction == ETextDirection::RIGHT)
+			fullStringWidth += advance.x * text_.scale.x * text_.spacing;
+		else if (text_.direction == ETextDirection::DOWN)
+			fullStringWidth += advance.y * text_.scale.y * text_.spacing;
 	}
 
 	Float32 alignOffset = 0.0f;
-	if (alignment == ETextAlignment::MIDDLE)
+	if (text_.alignment == ETextAlignment::MIDDLE)
 		alignOffset = (Float32)fullStringWidth / 2.0f;
-	else if (alignment == ETextAlignment::END)
+	else if (text_.alignment == ETextAlignment::END)
 		alignOffset = (Float32)fullStringWidth;
 
-	for (char letter : message_)
+	SInt32 currentPosition = 0;
+	if (text_.direction == ETextDirection::RIGHT)
+		currentPosition = text_.position.x;
+	else if (text_.direction == ETextDirection::DOWN)
+		currentPosition = text_.position.y;
+
+	batch_.instances.reserve(text_.message.size());
+
+	for (char letter : text_.message)
 	{
-		auto* spritesheet = cache[letter];
-		auto entity = registry.create();
-		auto& sprite = registry.emplace<Sprite>(entity);
-
-		if (ui_)
-			sprite.UseAsUI();
-
-		if (direction == ETextDirection::RIGHT)
-			sprite.position = {
-				currentPosition + (spritesheet->frame.size.x * scale.x * spacing / 2.0f) - alignOffset, position.y,
-				position.z};
-		else if (direction == ETextDirection::DOWN)
-			sprite.position = {
-				position.x, currentPosition - (spritesheet->frame.size.x * scale.x * spacing / 2.0f) + alignOffset,
-				position.z};
-
-		sprite.color = color;
-		sprite.scale = scale;
-		AssignSprite(sprite, spritesheet);
-
-		if (direction == ETextDirection::RIGHT)
-			currentPosition += (int)(spritesheet->frame.size.x * scale.x * spacing);
-		else if (direction == ETextDirection::DOWN)
-			currentPosition -= (int)(spritesheet->frame.size.y * scale.y * spacing);
-
-		entities.push_back(entity);
+		UInt32 code = (UInt8)letter;
+		if (code >= Font::s_GlyphCount || !font->present[code])
+			continue;
+
+		const auto& glyph = font->glyphs[code];
+		const auto& advance = font->advances[code];
+		auto& instance = batch_.instances.emplace_back();
+		static_cast<SpriteCutoutData&>(instance) = glyph;
+
+		if (text_.ui)
+			instance.UseAsUI();
+
+		if (text_.direction == ETextDirection::RIGHT)
+			instance.position = {
+				currentPosition + (advance.x * text_.scale.x * text_.spacing / 2.0f) - alignOffset,
+				text_.position.y, text_.position.z};
+		else if (text_.direction == ETextDirection::DOWN)
+			instance.position = {
+				text_.position.x,
+				currentPosition - (advance.x * text_.scale.x * text_.spacing / 2.0f) + alignOffset,
+				text_.position.z};
+
+		instance.color = text_.color;
+		instance.scale = text_.scale;
+
+		if (text_.direction == ETextDirection::RIGHT)
+			currentPosition += (int)(advance.x * text_.scale.x * text_.spacing);
+		else if (text_.direction == ETextDirection::DOWN)
+			currentPosition -= (int)(advance.y * text_.scale.y * text_.spacing);
 	}
 }
 
-void Text::Clear()
+Font* TextSystem::GenerateDistanceFieldFont(
+	const String& name_, const Font& source_, UInt32 cellSize_, UInt32 spread_)
+{
+	assert(source_.texture != nullptr);
+	assert(cellSize_ > 2 * spread_ + 1);
+
+	// flipped like every other texture, so cutouts index the pixels the same way they index the texture
+	int sourceWidth, sourceHeight, sourceChannels;
+	stbi_set_flip_vertically_on_load(1);
+	UInt8* pixels = stbi_load(
+		source_.texture->Path().string().c_str(), &sourceWidth, &sourceHeight, &sourceChannels, 4);
+
+	if (pixels == nullptr)
+	{
+		Engine::Dispatcher().trigger<Error>(
+			Error {fmt::format("Couldn't read the pixels of {} for font {}", source_.texture->Name(), name_)});
+		return nullptr;
+	}
+
+	UInt32 glyphCount = 0;
+	Float32 largestGlyph = 1.0f;
+	for (UInt32 code = 0; code < Font::s_GlyphCount; code++)
+	{
+		if (!source_.present[code])
+			continue;
+
+		glyphCount++;
+		largestGlyph = std::max({largestGlyph, source_.glyphs[code].size.x, source_.glyphs[code].size.y});
+	}
+
+	// one scale for the whole font keeps glyphs the same size relative to each other
+	const Float32 scale = (Float32)(cellSize_ - 2 * spread_ - 1) / largestGlyph;
+	const UInt32 columns = (UInt32)std::ceil(std::sqrt((Float32)std::max(glyphCount, 1u)));
+	const UInt32 rows = (glyphCount + columns - 1) / columns;
+	const UInt32 atlasWidth = columns * cellSize_;
+	const UInt32 atlasHeight = std::max(rows, 1u) * cellSize_;
+
+	// the source is sampled at least as finely as the atlas, and the margin covers the whole spread
+	const UInt32 resolution = std::max(1u, (UInt32)std::ceil(scale));
+	const UInt32 margin = (UInt32)std::ceil((Float32)spread_ / scale) + 1;
+
+	Sequence<UInt8> atlas(atlasWidth * atlasHeight, 0);
+	auto* font = new Font();
+
+	UInt32 cell = 0;
+	for (UInt32 code = 0; code < Font::s_GlyphCount; code++)
+	{
+		if (!source_.present[code])
+			continue;
+
+		const auto& cutout = source_.glyphs[code];
+		const SInt32 glyphX = (SInt32)std::round(cutout.subOrigin.x * sourceWidth);
+		const SInt32 glyphY = (SInt32)std::round(cutout.subOrigin.y * sourceHeight);
+		const UInt32 glyphWidth = (UInt32)cutout.size.x;
+		const UInt32 glyphHeight = (UInt32)cutout.size.y;
+
+		const UInt32 maskWidth = (glyphWidth + 2 * margin) * resolution;
+		const UInt32 maskHeight = (glyphHeight + 2 * margin) * resolution;
+		Sequence<UInt8> mask(maskWidth * maskHeight, 0);
+
+		for (UInt32 y = 0; y < maskHeight; y++)
+		{
+			for (UInt32 x = 0; x < maskWidth; x++)
+			{
+				const SInt32 sourceX = glyphX + (SInt32)(x / resolution) - (SInt32)margin;
+				const SInt32 sourceY = glyphY + (SInt32)(y / resolution) - (SInt32)margin;
+				if (sourceX < glyphX || sourceY < glyphY || sourceX >= glyphX + (SInt32)glyphWidth ||
+					sourceY >= glyphY + (SInt32)glyphHeight)
+					continue;
+
+				mask[y * maskWidth + x] = pixels[(sourceY * sourceWidth + sourceX) * 4 + 3] > 127 ? 1 : 0;
+			}
+		}
+
+		const auto field = SignedDistanceField(mask, maskWidth, maskHeight);
+
+		const UInt32 cellX = (cell % columns) * cellSize_;
+		const UInt32 cellY = (cell / columns) * cellSize_;
+		const UInt32 outWidth = (UInt32)std::ceil(glyphWidth * scale) + 2 * spread_;
+		const UInt32 outHeight = (UInt32)std::ceil(glyphHeight * scale) + 2 * spread_;
+
+		for (UInt32 y = 0; y < outHeight; y++)
+		{
+			for (UInt32 x = 0; x < outWidth; x++)
+			{
+				// atlas texel center back into glyph pixels, then into the padded mask
+				const Float32 glyphU = ((Float32)x + 0.5f - (Float32)spread_) / scale + (Float32)margin;
+				const Float32 glyphV = ((Float32)y + 0.5f - (Float32)spread_) / scale + (Float32)margin;
+				const UInt32 maskX = std::min((UInt32)std::max(glyphU * resolution, 0.0f), maskWidth - 1);
+				const UInt32 maskY = std::min((UInt32)std::max(glyphV * resolution, 0.0f), maskHeight - 1);
+
+				const Float32 distance = field[maskY * maskWidth + maskX] / (Float32)resolution * scale;
+				const Float32 value = std::clamp(0.5f - distance / (2.0f * (Float32)spread_), 0.0f, 1.0f);
+
+				atlas[(cellY + y) * atlasWidth + cellX + x] = (UInt8)std::round(value * 255.0f);
+			}
+		}
+
+		auto& glyph = font->glyphs[code];
+		glyph.subOrigin = {(Float32)cellX / atlasWidth, (Float32)cellY / atlasHeight};
+		glyph.subSize = {(Float32)outWidth / atlasWidth, (Float32)outHeight / atlasHeight};
+
+		// the quad also covers the spread, the advance stays that of the bitmap glyph
+		glyph.size = {(Float32)outWidth / scale, (Float32)outHeight / scale};
+		font->advances[code] = cutout.size;
+		font->present[code] = true;
+
+		cell++;
+	}
+
+	stbi_image_free(pixels);
+
+	auto textureName = fmt::format("fonts:{}", name_);
+	auto& textures = Engine::Res<Texture>();
+	if (textures.contains(textureName))
+		delete textures[textureName];
+
+	auto* texture = new Texture(textureName, source_.texture->Path(), atlas.data(), atlasWidth, atlasHeight, 1);
+
+	// distance fields are meant to be interpolated, the edge is found per pixel in the shader
+	GLState::BindTexture(GL_TEXTURE_2D, texture->TextureId());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+	textures[textureName] = texture;
+	font->texture = texture;
+
+	Logger::info(
+		"Distance field font {} generated from {}: {} glyphs in a {}x{} atlas", name_, source_.texture->Name(),
+		glyphCount, atlasWidth, atlasHeight);
+
+	return font;
+}
+
+void TextSystem::OnLoadAsset(AssetLoadRequest<Font> request_)
+{
+	FilePath path(request_.path);
+	FileInputStream handle;
+	handle.open(Files::absolute(path));
+
+	if (!handle.is_open())
+	{
+		Engine::Dispatcher().trigger<Error>(Error {fmt::format("Couldn't open font file '{}'.", request_.path)});
+		return;
+	}
+
+	JSON::json json;
+	handle >> json;
+
+	String name = json["font-name"];
+	String source = json["source"];
+	UInt32 cellSize = json.value("cell-size", 32u);
+	UInt32 spread = json.value("spread", 4u);
+
+	auto* font = GenerateDistanceFieldFont(name, *Font::Get(source), cellSize, spread);
+	if (font == nullptr)
+		return;
+
+	if (json.contains("shader"))
+		font->shader = ShaderSystem::Get(json["shader"].get<String>());
+
+	auto& fonts = Engine::Res<Font>();
+	if (fonts.contains(name))
+		delete fonts[name];
+
+	fonts[name] = font;
+}
+
+void TextSystem::OnPreRender()
 {
 	auto& registry = Engine::Registry();
+	auto view = registry.view<Text>();
 
-	if (!entities.empty())
+	for (auto entity : view)
 	{
-		registry.destroy(entities.begin(), entities.end());
-		entities.clear();
+		auto& text = view.get<Text>(entity);
+		if (text.laidOut == text && registry.all_of<SpriteBatch>(entity))
+			continue;
+
+		Layout(text, registry.get_or_emplace<SpriteBatch>(entity));
+		text.laidOut = text;
 	}
-}
\ No newline at end of file
+}
+
+void TextSystem::OnTextDestroyed(Registry& registry_, Entity entity_)
+{
+	// the batch is the text's glyph run, it goes away together with the text
+	if (registry_.all_of<SpriteBatch>(entity_))
+		registry_.remove<SpriteBatch>(entity_);
+}
+
+void TextSystem::SpinUp()
+{
+	Engine::Dispatcher().sink<AssetLoadRequest<Font>>().connect<&TextSystem::OnLoadAsset>(this);
+	Engine::Dispatcher().sink<PreRender>().connect<&TextSystem::OnPreRender>(this);
+	Engine::Registry().on_destroy<Text>().connect<&TextSystem::OnTextDestroyed>(this);
+
+	for (const auto& entry : Files::recursive_directory_iterator("fonts"))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".json")
+			Engine::Dispatcher().trigger<AssetLoadRequest<Font>>(AssetLoadRequest<Font> {entry.path().string()});
+	}
+
+	Engine::Dispatcher().trigger<AssetLoadFinished<Font>>(AssetLoadFinished<Font> {});
+}
+
+void TextSystem::WindDown()
+{
+	Engine::Dispatcher().sink<AssetLoadRequest<Font>>().disconnect<&TextSystem::OnLoadAsset>(this);
+	Engine::Dispatcher().sink<PreRender>().disconnect<&TextSystem::OnPreRender>(this);
+	Engine::Registry().on_destroy<Text>().disconnect<&TextSystem::OnTextDestroyed>(this);
+
+	for (const auto& [name, font] : Engine::Res<Font>())
+	{
+		delete font;
+	}
+	Engine::Res<Font>().clear();
+}
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "core/core.h"
+#include "core/graphics/sprite.h"
+#include "core/graphics/window.h"
+#include "core/system.h"
+
+using namespace dagger;
 
 enum struct ETextDirection
 {
@@ -15,7 +20,24 @@ enum struct ETextAlignment
 	END
 };
 
-struct Text
+// Font: glyph metrics of a font, indexed by character code.
+// Bitmap fonts are built once from their spritesheet frames, so laying out text never formats frame names.
+// Distance field fonts are generated from a bitmap font when the fonts folder is loaded, see TextSystem.
+struct Font
+{
+	constexpr static UInt32 s_GlyphCount = 128;
+
+	Texture* texture {nullptr};
+	ViewPtr<Shader> shader {nullptr};
+	StaticArray<SpriteCutoutData, s_GlyphCount> glyphs {};
+	StaticArray<Vector2, s_GlyphCount> advances {};
+	StaticArray<Bool, s_GlyphCount> present {};
+
+	static Font* Get(const String& name_);
+};
+
+// TextProperties: everything that decides where the glyphs of a text end up.
+struct TextProperties
 {
 	String font;
 	Vector4 color {1.0f, 1.0f, 1.0f, 1.0f};
@@ -23,10 +45,44 @@ struct Text
 	ETextAlignment alignment {ETextAlignment::MIDDLE};
 	Vector2 scale {1.0f, 1.0f};
 	Float32 spacing {1.0f};
-	Sequence<Entity> entities;
+	String message;
+
+	Vector3 position {0, 0, 0};
+	Bool ui {true};
+
+	Bool operator==(const TextProperties& other_) const;
+	Bool operator!=(const TextProperties& other_) const;
+};
 
-	Vector3 position;
+// Text: drawn by TextSystem as a single SpriteBatch on the same entity.
+// The glyph run is only rebuilt when one of the properties differs from the last layout.
+struct Text : public TextProperties
+{
+	TextProperties laidOut;
 
 	void Set(String font_, String message_, Vector3 pos_ = {0, 0, 0}, Bool ui_ = true);
 	void Clear();
-};
\ No newline at end of file
+};
+
+class TextSystem
+	: public System
+	, public Subscriber<PreRender, AssetLoadRequest<Font>>
+{
+	void OnPreRender();
+	void OnTextDestroyed(Registry& registry_, Entity entity_);
+
+	static void Layout(const Text& text_, SpriteBatch& batch_);
+	static Font* GenerateDistanceFieldFont(
+		const String& name_, const Font& source_, UInt32 cellSize_, UInt32 spread_);
+
+public:
+	inline String SystemName() const override
+	{
+		return "Text System";
+	}
+
+	void OnLoadAsset(AssetLoadRequest<Font> request_);
+
+	void SpinUp() override;
+	void WindDown() override;
+};
@@ -2,6 +2,7 @@
 
 #include "core/core.h"
 #include "core/filesystem.h"
+#include "core/graphics/gl_state.h"
 
 #include <glad/glad.h>
 
@@ -50,6 +51,11 @@ public:
 		return m_Name;
 	}
 
+	inline FilePath Path() const
+	{
+		return m_Path;
+	}
+
 	Texture() = default;
 
 	Texture(String name_, const FilePath path_, UInt8* data_, UInt32 width_, UInt32 height_, UInt32 channels_)
@@ -63,19 +69,29 @@ public:
 		assert(m_Ratio > 0);
 
 		glEnable(GL_TEXTURE_2D);
-		glActiveTexture(GL_TEXTURE0);
+		GLState::ActiveTexture(GL_TEXTURE0);
 
 		glGenTextures(1, &m_TextureId);
-		glBindTexture(GL_TEXTURE_2D, m_TextureId);
+		GLState::BindTexture(GL_TEXTURE_2D, m_TextureId);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexImage2D(
-			GL_TEXTURE_2D, 0, channels_ == 4 ? GL_RGBA : GL_RGB, m_Width, m_Height, 0,
-			channels_ == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, data_);
-
-		glBindTexture(GL_TEXTURE_2D, 0);
+		if (channels_ == 1)
+		{
+			// single channel rows are tightly packed, so they can't rely on the default 4-byte row alignment
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_Width, m_Height, 0, GL_RED, GL_UNSIGNED_BYTE, data_);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		}
+		else
+		{
+			glTexImage2D(
+				GL_TEXTURE_2D, 0, channels_ == 4 ? GL_RGBA : GL_RGB, m_Width, m_Height, 0,
+				channels_ == 4 ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, data_);
+		}
+
+		GLState::BindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	Texture(const Texture& other_) = default;
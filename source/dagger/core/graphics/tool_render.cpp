@@ -1,6 +1,8 @@
 #include "tool_render.h"
 
 #include "core/engine.h"
+#include "gl_state.h"
+#include "gpu_timer.h"
 #include "sprite.h"
 #include "texture.h"
 #include "textures.h"
@@ -15,10 +17,10 @@ using namespace dagger;
 void ToolRenderSystem::SpinUp()
 {
 	glGenVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
+	GLState::BindVertexArray(m_VAO);
 
 	glGenBuffers(1, &m_StaticMeshVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(m_VerticesAndTexCoords), m_VerticesAndTexCoords, GL_STATIC_DRAW);
 
 	// attribute #0: vertex position
@@ -32,7 +34,7 @@ void ToolRenderSystem::SpinUp()
 	const GLsizei dataSize = sizeof(SpriteData);
 
 	glGenBuffers(1, &m_InstanceQuadInfoVBO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
 	glBufferData(GL_ARRAY_BUFFER, s_BufferSize, nullptr, GL_STREAM_DRAW);
 
 	const StaticArray<Pair<UInt32, UInt32>, 9> sizesAndStrides = {
@@ -57,15 +59,29 @@ void ToolRenderSystem::SpinUp()
 		glVertexAttribDivisor(index, 1);
 	}
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 
 	glEnable(GL_TEXTURE_2D);
-	glActiveTexture(GL_TEXTURE0);
+	GLState::ActiveTexture(GL_TEXTURE0);
 
-	Engine::Dispatcher().sink<Render>().connect<&ToolRenderSystem::OnRender>(this);
+	Engine::Dispatcher().sink<RenderExtract>().connect<&ToolRenderSystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<Render>().connect<&ToolRenderSystem::OnRender>(this);
 }
 
-void ToolRenderSystem::OnRender()
+void ToolRenderSystem::OnRenderExtract(RenderExtract extract_)
+{
+	auto& sprites = m_Frames[extract_.buffer];
+	sprites.clear();
+
+	if (registry == nullptr)
+		return;
+
+	// only copy here, sorting and uploading happen on the render side
+	const auto& view = registry->view<Sprite>();
+	sprites.assign(view.storage().begin(), view.storage().end());
+}
+
+void ToolRenderSystem::OnRender(Render render_)
 {
 	static auto sortSprites = [](const Sprite& a_, const Sprite& b_)
 	{
@@ -105,15 +121,16 @@ void ToolRenderSystem::OnRender()
 	if (registry == nullptr)
 		return;
 
-	glBindVertexArray(m_VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
+	GPUPassScope pass {"Tool Sprites"};
+
+	GLState::BindVertexArray(m_VAO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_InstanceQuadInfoVBO);
 
 	// get a view of all the entities and their sprite components
 	ViewPtr<Texture> prevTexture {nullptr};
 	ViewPtr<Shader> prevShader {nullptr};
 
-	const auto& view = registry->view<Sprite>();
-	Sequence<Sprite> sprites {view.storage().begin(), view.storage().end()};
+	auto& sprites = m_Frames[render_.buffer];
 	std::sort(sprites.begin(), sprites.end(), sortSprites);
 	Sequence<SpriteData> currentRender {};
 
@@ -135,8 +152,7 @@ void ToolRenderSystem::OnRender()
 		if (prevShader != ptr->shader)
 		{
 			prevShader = ptr->shader;
-			glUseProgram(prevShader->programId);
-			Engine::Dispatcher().trigger<ShaderChangeRequest>(ShaderChangeRequest(prevShader));
+			GLState::UseProgram(prevShader->programId);
 		}
 
 		prevTexture = ptr->image;
@@ -157,23 +173,21 @@ void ToolRenderSystem::OnRender()
 		memcpy(m_Data, &(*currentRender.begin()), renderSize);
 		glUnmapBuffer(GL_ARRAY_BUFFER);
 
-		glBindTexture(GL_TEXTURE_2D, prevTexture->TextureId());
+		GLState::BindTexture(GL_TEXTURE_2D, prevTexture->TextureId());
 		glDrawArraysInstanced(GL_TRIANGLES, 0, s_VertexCount, (GLsizei)currentRender.size());
 		currentRender.clear();
 	}
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
 }
 
 void ToolRenderSystem::WindDown()
 {
-	glBindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, m_StaticMeshVBO);
 	glUnmapBuffer(GL_ARRAY_BUFFER);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
 	glDeleteBuffers(1, &m_StaticMeshVBO);
 
 	glDeleteVertexArrays(1, &m_VAO);
 
-	Engine::Dispatcher().sink<Render>().disconnect<&ToolRenderSystem::OnRender>(this);
+	Engine::Dispatcher().sink<RenderExtract>().disconnect<&ToolRenderSystem::OnRenderExtract>(this);
+	Engine::RenderDispatcher().sink<Render>().disconnect<&ToolRenderSystem::OnRender>(this);
 }
@@ -16,7 +16,7 @@ using namespace dagger;
 
 class ToolRenderSystem
 	: public System
-	, public Subscriber<Render, ShaderChangeRequest>
+	, public Subscriber<RenderExtract, Render>
 {
 	const Float32 m_VerticesAndTexCoords[24] = {-0.5f, -0.5f, 0.0f, 0.0f, -0.5f, 0.5f,	0.0f, 1.0f,
 												0.5f,  0.5f,  1.0f, 1.0f, 0.5f,	 -0.5f, 1.0f, 0.0f,
@@ -29,7 +29,10 @@ class ToolRenderSystem
 
 	UInt8 m_Index = 0;
 
-	void OnRender();
+	StaticArray<Sequence<Sprite>, WindowSystem::s_FrameBufferCount> m_Frames;
+
+	void OnRenderExtract(RenderExtract extract_);
+	void OnRender(Render render_);
 
 public:
 	inline String SystemName() const override
@@ -45,5 +48,5 @@ public:
 	void SpinUp() override;
 	void WindDown() override;
 
-	Registry* registry;
+	Registry* registry {nullptr};
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "core/core.h"
 #include "core/engine.h"
+#include "core/input/input_queue.h"
+#include "gl_state.h"
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -19,8 +21,17 @@ static void ErrorCallback(int error_, const char* description_)
 	Engine::Dispatcher().trigger<Error>(Error {description_});
 }
 
+// stamps input when GLFW delivers it, InputSystem picks it up at the start of its next run
+static void PushInputEvent(EInputEventType type_, EDaggerInputState action_, UInt32 input_, Vector2 cursor_)
+{
+	auto* queue = Engine::GetDefaultResource<InputEventQueue>();
+	if (queue != nullptr)
+		queue->Push(InputEvent {type_, action_, input_, cursor_, TimeSnapshot()});
+}
+
 static void KeyCallback(GLFWwindow* window_, int key_, int scancode_, int action_, int mods_)
 {
+	PushInputEvent(EInputEventType::Key, (EDaggerInputState)action_, (UInt32)key_, {0, 0});
 	Engine::Dispatcher().trigger<KeyboardEvent>(
 		KeyboardEvent {(EDaggerKeyboard)key_, (EDaggerInputState)action_, (UInt32)scancode_, (UInt32)mods_});
 }
@@ -37,12 +48,14 @@ static void ScrollCallback(GLFWwindow* window_, double xOffset_, double yOffset_
 
 static void MouseCallback(GLFWwindow* window_, int button_, int action_, int mods_)
 {
+	PushInputEvent(EInputEventType::Button, (EDaggerInputState)action_, (UInt32)(button_ + 150), {0, 0});
 	Engine::Dispatcher().trigger<MouseEvent>(
 		MouseEvent {(EDaggerMouse)(button_ + 150), (EDaggerInputState)action_, (UInt32)mods_});
 }
 
 static void CursorCallback(GLFWwindow* window_, double x_, double y_)
 {
+	PushInputEvent(EInputEventType::Cursor, EDaggerInputState::Held, 0, Vector2 {(Float32)x_, (Float32)y_});
 	Engine::Dispatcher().trigger<CursorEvent>(CursorEvent {(Float64)x_, (Float64)y_});
 }
 
@@ -51,12 +64,6 @@ static void WindowResizeCallback(GLFWwindow* window_, int width_, int height_)
 	Engine::Dispatcher().trigger<WindowResized>(WindowResized {window_, (UInt32)width_, (UInt32)height_});
 }
 
-void WindowSystem::UpdateViewProjectionMatrix()
-{
-	glUniformMatrix4fv((GLuint)m_Matrices.viewportMatrixId, 1, false, glm::value_ptr(m_Config.viewport));	  // NOLINT
-	glUniformMatrix4fv((GLuint)m_Matrices.projectionMatrixId, 1, false, glm::value_ptr(m_Config.projection)); // NOLINT
-}
-
 void WindowSystem::UpdateViewProjectionMatrix(RenderConfig& config_, Camera& camera_)
 {
 	SetViewProjectionMatrix(config_, camera_, config_.lastSize.x, config_.lastSize.y);
@@ -86,9 +93,6 @@ void WindowSystem::SetViewProjectionMatrix(RenderConfig& config_, Camera& camera
 		config_.viewBounds = Vector4 {0, 0, width_, height_};
 		break;
 	}
-
-	glUniformMatrix4fv((GLuint)m_Matrices.viewportMatrixId, 1, false, glm::value_ptr(config_.viewport));	 // NOLINT
-	glUniformMatrix4fv((GLuint)m_Matrices.projectionMatrixId, 1, false, glm::value_ptr(config_.projection)); // NOLINT
 }
 
 void WindowSystem::OnWindowResized(WindowResized resized_)
@@ -102,17 +106,6 @@ void WindowSystem::OnWindowResized(WindowResized resized_)
 	SetViewProjectionMatrix(*config, *camera, (Float32)width_, (Float32)height_);
 }
 
-void WindowSystem::OnShaderChanged(ShaderChangeRequest request_)
-{
-	m_Matrices.cameraMatrixId = glGetUniformLocation(request_.GetShader()->programId, Shader::s_CameraMatrixName);
-	m_Matrices.viewportMatrixId = glGetUniformLocation(request_.GetShader()->programId, Shader::s_ViewportMatrixName);
-	m_Matrices.projectionMatrixId =
-		glGetUniformLocation(request_.GetShader()->programId, Shader::s_ProjectionMatrixName);
-
-	UpdateViewProjectionMatrix();
-	UpdateCameraMatrix();
-}
-
 void Camera::Update()
 {
 	auto* window = Engine::GetDefaultResource<WindowSystem>();
@@ -132,7 +125,6 @@ void WindowSystem::UpdateCameraMatrix()
 	glm::mat4 scaleMatrix = glm::scale(glm::vec3(camera->zoom));
 	m_Config.camera =
 		scaleMatrix * glm::lookAt(camera->position, camera->position - glm::vec3(0, 0, 10000), glm::vec3(0, 1, 0));
-	glUniformMatrix4fv((GLuint)m_Matrices.cameraMatrixId, 1, false, glm::value_ptr(m_Config.camera)); // NOLINT
 }
 
 void WindowSystem::SpinUp()
@@ -144,6 +136,8 @@ void WindowSystem::SpinUp()
 	m_Config.fullscreen = strcmp(Engine::GetIniFile().GetValue("window", "fullscreen", "false"), "true") == 0;
 	m_Config.resizable = strcmp(Engine::GetIniFile().GetValue("window", "resizable", "false"), "true") == 0;
 	m_Config.vsync = strcmp(Engine::GetIniFile().GetValue("window", "vsync", "false"), "true") == 0;
+	m_Config.pipelined = strcmp(Engine::GetIniFile().GetValue("window", "pipelined", "false"), "true") == 0;
+	m_Config.hidden = strcmp(Engine::GetIniFile().GetValue("window", "hidden", "false"), "true") == 0;
 
 	assert(m_Config.windowWidth > 0 && m_Config.windowHeight > 0);
 
@@ -163,6 +157,8 @@ void WindowSystem::SpinUp()
 	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_RESIZABLE, m_Config.resizable ? GLFW_TRUE : GLFW_FALSE);
+	// for replays and benchmarks: everything still renders, just never to the screen
+	glfwWindowHint(GLFW_VISIBLE, m_Config.hidden ? GLFW_FALSE : GLFW_TRUE);
 
 	GLFWmonitor* monitor = nullptr;
 
@@ -215,9 +211,11 @@ void WindowSystem::SpinUp()
 
 	Engine::PutDefaultResource<RenderConfig>(&m_Config);
 	Engine::PutDefaultResource<Camera>(&m_Camera);
+	Engine::PutDefaultResource<GPUTimer>(&m_GPUTimer);
 
-	Engine::Dispatcher().sink<ShaderChangeRequest>().connect<&WindowSystem::OnShaderChanged>(this);
 	Engine::Dispatcher().sink<WindowResized>().connect<&WindowSystem::OnWindowResized>(this);
+	Engine::Dispatcher().sink<Exit>().connect<&WindowSystem::OnExit>(this);
+	Engine::Dispatcher().sink<Error>().connect<&WindowSystem::OnError>(this);
 
 	WindowResizeCallback(window, m_Config.windowWidth, m_Config.windowHeight);
 
@@ -228,6 +226,11 @@ void WindowSystem::SpinUp()
 	glfwSetScrollCallback(window, ScrollCallback);
 	glfwSetWindowSizeCallback(window, WindowResizeCallback);
 
+	glGenBuffers(1, &m_FrameConstantsUBO);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_FrameConstantsUBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameConstants), nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, Shader::s_FrameConstantsBinding, m_FrameConstantsUBO);
+
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glEnable(GL_BLEND);
 
@@ -236,21 +239,150 @@ void WindowSystem::SpinUp()
 	//    glDepthFunc(GL_LEQUAL);
 }
 
+void WindowSystem::SubmitFrame()
+{
+	const auto& frame = m_Frames[m_SubmitIndex];
+
+	GLState::NextFrame();
+	m_GPUTimer.BeginFrame();
+
+	glViewport(0, 0, frame.framebufferWidth, frame.framebufferHeight);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glClearColor(0.39f, 0.58f, 0.92f, 1.0f);
+
+	// the only matrix upload of the frame, every program reads it through the shared binding point
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_FrameConstantsUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameConstants), &frame.constants);
+
+	Engine::RenderDispatcher().trigger<Render>(Render {m_SubmitIndex});
+	Engine::RenderDispatcher().trigger<ToolRender>(ToolRender {m_SubmitIndex});
+}
+
+void WindowSystem::StartRenderThread()
+{
+	Logger::info("Starting render thread");
+
+	// every GL resource has been created by now; from here on the context belongs to the render thread
+	glfwMakeContextCurrent(nullptr);
+	m_RenderThread = std::thread(&WindowSystem::RenderThreadLoop, this);
+}
+
+void WindowSystem::RenderThreadLoop()
+{
+	glfwMakeContextCurrent(m_Config.window);
+	glfwSwapInterval(m_Config.vsync ? 1 : 0);
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock {m_RenderMutex};
+			m_RenderSignal.wait(lock, [this]() { return m_FramePending || m_StopRendering; });
+
+			// stopping only once the last handed-over frame has been drawn
+			if (!m_FramePending)
+				break;
+		}
+
+		SubmitFrame();
+		glfwSwapBuffers(m_Config.window);
+
+		{
+			std::lock_guard<std::mutex> lock {m_RenderMutex};
+			m_FramePending = false;
+		}
+		m_RenderSignal.notify_all();
+
+		// wakes the main thread if it is waiting for this frame in WaitForRenderThread
+		glfwPostEmptyEvent();
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+void WindowSystem::WaitForRenderThread()
+{
+	// keep delivering input while the render thread presents, so events are stamped close to when they happen
+	while (true)
+	{
+		{
+			std::lock_guard<std::mutex> lock {m_RenderMutex};
+			if (!m_FramePending)
+				return;
+		}
+		glfwWaitEventsTimeout(0.005);
+	}
+}
+
+void WindowSystem::StopRenderThread()
+{
+	if (!m_RenderThread.joinable() || std::this_thread::get_id() == m_RenderThread.get_id())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock {m_RenderMutex};
+		m_StopRendering = true;
+	}
+	m_RenderSignal.notify_all();
+	m_RenderThread.join();
+
+	// systems winding down still need the context to release their resources
+	glfwMakeContextCurrent(m_Config.window);
+	Logger::info("Render thread stopped");
+}
+
+void WindowSystem::OnExit()
+{
+	StopRenderThread();
+}
+
+void WindowSystem::OnError(Error /*unused*/)
+{
+	StopRenderThread();
+}
+
 void WindowSystem::Run()
 {
 	auto* window = m_Config.window;
+
+	if (m_Config.pipelined && !m_RenderThread.joinable() && !m_StopRendering)
+		StartRenderThread();
+
 	Engine::Dispatcher().trigger<PreRender>();
 
 	glfwGetFramebufferSize(m_Config.window, &m_Config.windowWidth, &m_Config.windowHeight);
+	UpdateCameraMatrix();
 
-	glViewport(0, 0, m_Config.windowWidth, m_Config.windowHeight);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	glClearColor(0.39f, 0.58f, 0.92f, 1.0f);
+	// the render thread only ever reads the other buffer, so extraction can overlap with it
+	auto& frame = m_Frames[m_ExtractIndex];
+	frame.framebufferWidth = m_Config.windowWidth;
+	frame.framebufferHeight = m_Config.windowHeight;
+	frame.constants.uiViewProjection = m_Config.projection * m_Config.viewport;
+	frame.constants.worldViewProjection = frame.constants.uiViewProjection * m_Config.camera;
+
+	Engine::Dispatcher().trigger<RenderExtract>(RenderExtract {m_ExtractIndex});
 
-	Engine::Dispatcher().trigger<Render>();
-	Engine::Dispatcher().trigger<ToolRender>();
+	if (m_RenderThread.joinable())
+	{
+		// at most one frame in flight: this is the one frame of added latency
+		WaitForRenderThread();
+		{
+			std::lock_guard<std::mutex> lock {m_RenderMutex};
+			m_SubmitIndex = m_ExtractIndex;
+			m_FramePending = true;
+		}
+		m_RenderSignal.notify_all();
+	}
+	else
+	{
+		m_SubmitIndex = m_ExtractIndex;
+		SubmitFrame();
 
-	glfwSwapBuffers(window);
+		// input that came in while the frame was built is stamped before the swap can block on vsync
+		glfwPollEvents();
+		glfwSwapBuffers(window);
+	}
+
+	m_ExtractIndex = (m_ExtractIndex + 1) % s_FrameBufferCount;
 
 	Engine::Dispatcher().trigger<PostRender>();
 
@@ -265,9 +397,16 @@ void WindowSystem::WindDown()
 {
 	Logger::info("Winding down renderer");
 
+	StopRenderThread();
+
+	m_GPUTimer.Release();
+	glDeleteBuffers(1, &m_FrameConstantsUBO);
+	Engine::PutDefaultResource<GPUTimer>(nullptr);
+
 	glfwDestroyWindow(m_Config.window);
 	glfwTerminate();
 
-	Engine::Dispatcher().sink<ShaderChangeRequest>().disconnect<&WindowSystem::OnShaderChanged>(this);
 	Engine::Dispatcher().sink<WindowResized>().disconnect<&WindowSystem::OnWindowResized>(this);
+	Engine::Dispatcher().sink<Exit>().disconnect<&WindowSystem::OnExit>(this);
+	Engine::Dispatcher().sink<Error>().disconnect<&WindowSystem::OnError>(this);
 }
\ No newline at end of file
@@ -3,25 +3,38 @@
 #include "camera.h"
 #include "core/core.h"
 #include "core/system.h"
+#include "gpu_timer.h"
 #include "shaders.h"
 
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 #include <spdlog/spdlog.h>
 
+#include <condition_variable>
 #include <deque>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 using namespace dagger;
 
 struct PreRender
 {
 };
+// RenderExtract: fired on the main thread at the end of simulation.
+// Render systems copy whatever they need to draw into the given snapshot buffer.
+struct RenderExtract
+{
+	UInt32 buffer;
+};
+// Render and ToolRender: fired through Engine::RenderDispatcher() and draw from the given snapshot buffer.
 struct Render
 {
+	UInt32 buffer;
 };
 struct ToolRender
 {
+	UInt32 buffer;
 };
 struct PostRender
 {
@@ -48,6 +61,8 @@ struct RenderConfig
 	Bool fullscreen;
 	Bool resizable;
 	Bool vsync;
+	Bool pipelined;
+	Bool hidden;
 	GLsizei windowWidth;
 	GLsizei windowHeight;
 	GLFWwindow* window;
@@ -59,23 +74,57 @@ struct RenderConfig
 	Matrix4 camera;
 };
 
-struct CachedMatrices
+// FrameConstants: mirrors the std140 "FrameConstants" uniform block, uploaded once per frame.
+struct FrameConstants
 {
-	GLuint viewportMatrixId;
-	GLuint projectionMatrixId;
-	GLuint cameraMatrixId;
+	Matrix4 worldViewProjection {1.0f};
+	Matrix4 uiViewProjection {1.0f};
+};
+
+// RenderSnapshot: the part of the render config that a frame in flight needs.
+struct RenderSnapshot
+{
+	GLsizei framebufferWidth {0};
+	GLsizei framebufferHeight {0};
+	FrameConstants constants {};
 };
 
 class WindowSystem
 	: public System
-	, public Publisher<PreRender, Render, ToolRender, KeyboardEvent, MouseEvent, CursorEvent, Error>
+	, public Publisher<PreRender, RenderExtract, Render, ToolRender, KeyboardEvent, MouseEvent, CursorEvent, Error>
 {
+public:
+	// Snapshot buffers: one is being extracted into while the other is being drawn.
+	constexpr static UInt32 s_FrameBufferCount = 2;
+
+private:
 	RenderConfig m_Config;
-	CachedMatrices m_Matrices;
 	Camera m_Camera;
+	GLuint m_FrameConstantsUBO {0};
+	GPUTimer m_GPUTimer;
+
+	StaticArray<RenderSnapshot, s_FrameBufferCount> m_Frames;
+	UInt32 m_ExtractIndex {0};
+	UInt32 m_SubmitIndex {0};
+
+	std::thread m_RenderThread;
+	std::mutex m_RenderMutex;
+	std::condition_variable m_RenderSignal;
+	Bool m_FramePending {false};
+	Bool m_StopRendering {false};
+
+	void SubmitFrame();
+
+	void StartRenderThread();
+	void RenderThreadLoop();
+	void WaitForRenderThread();
+	void StopRenderThread();
+
+	void OnExit();
+	void OnError(Error error_);
 
 public:
-	WindowSystem() : m_Config {}, m_Matrices {}, m_Camera {} { }
+	WindowSystem() : m_Config {}, m_Camera {} { }
 
 	WindowSystem(const WindowSystem&) = delete;
 
@@ -84,15 +133,12 @@ public:
 		return "Window System";
 	}
 
-	void UpdateViewProjectionMatrix();
-
 	void UpdateViewProjectionMatrix(RenderConfig& config_, Camera& camera_);
 	void SetViewProjectionMatrix(RenderConfig& config_, Camera& camera_, Float32 width_, Float32 height_);
 
 	void UpdateCameraMatrix();
 
 	void OnWindowResized(WindowResized resized_);
-	void OnShaderChanged(ShaderChangeRequest request_);
 
 	void SpinUp() override;
 	void Run() override;
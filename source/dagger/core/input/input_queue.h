@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <atomic>
+
+namespace dagger
+{
+	enum class EInputEventType : UInt8
+	{
+		Key,
+		Button,
+		Cursor
+	};
+
+	// InputEvent: one raw input change, stamped when GLFW delivered it rather than when the frame got to it.
+	// WindowSystem pumps events before and after every swap, and keeps pumping while it waits on the
+	// render thread, so the stamp is within a fraction of a frame of the actual press.
+	struct InputEvent
+	{
+		EInputEventType type {EInputEventType::Key};
+		EDaggerInputState action {EDaggerInputState::Pressed};
+		// key or mouse button id, unused for the cursor
+		UInt32 input {0};
+		Vector2 cursor {0, 0};
+		TimePoint moment {};
+	};
+
+	// InputEventQueue: a fixed size, lock-free queue for exactly one producer and one consumer thread.
+	// Window callbacks push into it and InputSystem drains it once per frame. Events that don't fit are
+	// dropped and counted, the producer never waits.
+	class InputEventQueue
+	{
+	public:
+		constexpr static UInt32 s_Capacity = 1024;
+
+	private:
+		static_assert((s_Capacity & (s_Capacity - 1)) == 0, "capacity has to be a power of two");
+
+		StaticArray<InputEvent, s_Capacity> m_Events {};
+
+		// both only ever grow; the slot is the value masked by the capacity
+		alignas(64) std::atomic<UInt32> m_Head {0};
+		alignas(64) std::atomic<UInt32> m_Tail {0};
+		std::atomic<UInt32> m_Dropped {0};
+
+	public:
+		// producer only
+		inline Bool Push(const InputEvent& event_)
+		{
+			const UInt32 tail = m_Tail.load(std::memory_order_relaxed);
+			if (tail - m_Head.load(std::memory_order_acquire) == s_Capacity)
+			{
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			m_Events[tail & (s_Capacity - 1)] = event_;
+			m_Tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer only
+		inline Bool Pop(InputEvent& event_)
+		{
+			const UInt32 head = m_Head.load(std::memory_order_relaxed);
+			if (head == m_Tail.load(std::memory_order_acquire))
+				return false;
+
+			event_ = m_Events[head & (s_Capacity - 1)];
+			m_Head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		inline UInt32 Dropped() const
+		{
+			return m_Dropped.load(std::memory_order_relaxed);
+		}
+	};
+} // namespace dagger
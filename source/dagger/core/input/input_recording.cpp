@@ -0,0 +1,132 @@
+#include "input_recording.h"
+
+using namespace dagger;
+
+namespace
+{
+	struct RecordingHeader
+	{
+		constexpr static UInt32 s_Magic = 0x44474952; // "DGIR"
+		constexpr static UInt32 s_Version = 1;
+
+		UInt32 magic;
+		UInt32 version;
+		UInt64 seed;
+	};
+
+	struct RecordedFrame
+	{
+		SInt64 now;
+		Float32 deltaTime;
+		UInt32 eventCount;
+	};
+
+	struct RecordedEvent
+	{
+		SInt64 moment;
+		Float32 cursorX;
+		Float32 cursorY;
+		UInt32 input;
+		UInt8 type;
+		UInt8 action;
+	};
+
+	// microseconds are fine enough for hold durations and keep the offsets in range for days
+	SInt64 Offset(TimePoint start_, TimePoint moment_)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(moment_ - start_).count();
+	}
+} // namespace
+
+Bool InputRecorder::Open(const String& path_, UInt64 seed_)
+{
+	m_Output.open(path_, std::ios::binary | std::ios::trunc);
+	if (!m_Output.is_open())
+		return false;
+
+	const RecordingHeader header {RecordingHeader::s_Magic, RecordingHeader::s_Version, seed_};
+	m_Output.write(reinterpret_cast<const char*>(&header), sizeof(RecordingHeader));
+	m_Started = false;
+	return true;
+}
+
+void InputRecorder::Write(TimePoint now_, Float32 deltaTime_, const Sequence<InputEvent>& events_)
+{
+	if (!m_Started)
+	{
+		m_Start = now_;
+		m_Started = true;
+	}
+
+	const RecordedFrame frame {Offset(m_Start, now_), deltaTime_, static_cast<UInt32>(events_.size())};
+	m_Output.write(reinterpret_cast<const char*>(&frame), sizeof(RecordedFrame));
+
+	for (const auto& event : events_)
+	{
+		RecordedEvent recorded {};
+		recorded.moment = Offset(m_Start, event.moment);
+		recorded.cursorX = event.cursor.x;
+		recorded.cursorY = event.cursor.y;
+		recorded.input = event.input;
+		recorded.type = static_cast<UInt8>(event.type);
+		recorded.action = static_cast<UInt8>(event.action);
+		m_Output.write(reinterpret_cast<const char*>(&recorded), sizeof(RecordedEvent));
+	}
+}
+
+void InputRecorder::Close()
+{
+	m_Output.close();
+}
+
+Bool InputReplay::Open(const String& path_)
+{
+	m_Input.open(path_, std::ios::binary);
+	if (!m_Input.is_open())
+		return false;
+
+	RecordingHeader header {};
+	m_Input.read(reinterpret_cast<char*>(&header), sizeof(RecordingHeader));
+	if (!m_Input || header.magic != RecordingHeader::s_Magic || header.version != RecordingHeader::s_Version)
+	{
+		m_Input.close();
+		return false;
+	}
+
+	m_Seed = header.seed;
+	m_Start = TimeSnapshot();
+	return true;
+}
+
+Bool InputReplay::Next(ReplayFrame& frame_)
+{
+	RecordedFrame frame {};
+	m_Input.read(reinterpret_cast<char*>(&frame), sizeof(RecordedFrame));
+	if (!m_Input)
+		return false;
+
+	frame_.now = m_Start + std::chrono::microseconds {frame.now};
+	frame_.deltaTime = frame.deltaTime;
+	frame_.events.resize(frame.eventCount);
+
+	for (auto& event : frame_.events)
+	{
+		RecordedEvent recorded {};
+		m_Input.read(reinterpret_cast<char*>(&recorded), sizeof(RecordedEvent));
+		if (!m_Input)
+			return false;
+
+		event.moment = m_Start + std::chrono::microseconds {recorded.moment};
+		event.cursor = {recorded.cursorX, recorded.cursorY};
+		event.input = recorded.input;
+		event.type = static_cast<EInputEventType>(recorded.type);
+		event.action = static_cast<EDaggerInputState>(recorded.action);
+	}
+
+	return true;
+}
+
+void InputReplay::Close()
+{
+	m_Input.close();
+}
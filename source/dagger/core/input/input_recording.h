@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/core.h"
+#include "core/input/input_queue.h"
+
+#include <fstream>
+
+namespace dagger
+{
+	// ReplayFrame: everything InputSystem saw in one recorded frame.
+	struct ReplayFrame
+	{
+		TimePoint now {};
+		Float32 deltaTime {0.0f};
+		Sequence<InputEvent> events;
+	};
+
+	// InputRecorder: writes the master seed, then for every frame its clock, delta time and input events.
+	// Times are kept relative to the first frame, so a replay can put them on its own clock.
+	class InputRecorder
+	{
+		std::ofstream m_Output;
+		TimePoint m_Start {};
+		Bool m_Started {false};
+
+	public:
+		Bool Open(const String& path_, UInt64 seed_);
+		void Write(TimePoint now_, Float32 deltaTime_, const Sequence<InputEvent>& events_);
+		void Close();
+
+		inline Bool IsOpen() const
+		{
+			return m_Output.is_open();
+		}
+	};
+
+	// InputReplay: reads back what InputRecorder wrote, one frame at a time.
+	class InputReplay
+	{
+		std::ifstream m_Input;
+		TimePoint m_Start {};
+		UInt64 m_Seed {0};
+
+	public:
+		Bool Open(const String& path_);
+
+		// false once the recording runs out or is cut short
+		Bool Next(ReplayFrame& frame_);
+		void Close();
+
+		inline Bool IsOpen() const
+		{
+			return m_Input.is_open();
+		}
+
+		inline UInt64 Seed() const
+		{
+			return m_Seed;
+		}
+	};
+} // namespace dagger
@@ -11,64 +11,212 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
 using namespace dagger;
 
-void InputSystem::OnKeyboardEvent(KeyboardEvent input_)
+namespace
 {
-	if ((SInt32)input_.key < 0)
+	struct CommandTable
+	{
+		std::mutex mutex;
+		Map<String, UInt32> ids;
+		Sequence<String> names;
+	};
+
+	// function-local, so ids can be resolved while other translation units are still being initialized
+	CommandTable& Commands()
 	{
+		static CommandTable s_Table;
+		return s_Table;
+	}
+
+	// events can be stamped after the frame started, those count as just now
+	UInt32 MillisecondsBetween(TimePoint from_, TimePoint to_)
+	{
+		return to_ > from_ ? DurationToMilliseconds(to_ - from_) : 0;
+	}
+} // namespace
+
+UInt32 InputCommands::Id(const String& name_)
+{
+	auto& table = Commands();
+	std::lock_guard<std::mutex> lock {table.mutex};
+
+	auto found = table.ids.find(name_);
+	if (found != table.ids.end())
+		return found->second;
+
+	const UInt32 id = table.names.size();
+	table.ids[name_] = id;
+	table.names.push_back(name_);
+	return id;
+}
+
+String InputCommands::Name(UInt32 id_)
+{
+	auto& table = Commands();
+	std::lock_guard<std::mutex> lock {table.mutex};
+	return id_ < table.names.size() ? table.names[id_] : String {};
+}
+
+UInt32 InputCommands::Count()
+{
+	auto& table = Commands();
+	std::lock_guard<std::mutex> lock {table.mutex};
+	return table.names.size();
+}
+
+void InputSystem::ApplyEvent(const InputEvent& event_)
+{
+	if (event_.type == EInputEventType::Cursor)
+	{
+		m_InputState.cursor = event_.cursor;
 		return;
 	}
 
-	auto key = (UInt64)input_.key;
+	// unknown keys come in as -1
+	if (event_.input >= InputCount)
+	{
+		return;
+	}
 
-	if (input_.action == EDaggerInputState::Pressed)
+	const UInt32 input = event_.input;
+	Bool& isDown =
+		event_.type == EInputEventType::Button ? m_InputState.mouse[input - MouseStart] : m_InputState.keys[input];
+
+	if (event_.action == EDaggerInputState::Pressed)
 	{
-		m_InputState.keys[key] = true;
-		m_InputState.moments[key] = Engine::CurrentTime();
-		m_InputState.bitmap.set(key);
+		isDown = true;
+		m_InputState.moments[input] = event_.moment;
+		m_InputState.bitmap.set(input);
 	}
-	else if (input_.action == EDaggerInputState::Released)
+	else if (event_.action == EDaggerInputState::Released)
 	{
-		m_InputState.releasedLastFrame.emplace(key);
-		m_InputState.keys[key] = false;
-		m_InputState.moments.erase(key);
+		auto pressed = m_InputState.moments.find(input);
+		if (pressed != m_InputState.moments.end())
+		{
+			m_InputState.heldBeforeRelease[input] = MillisecondsBetween(pressed->second, event_.moment);
+			m_InputState.moments.erase(pressed);
+		}
+
+		m_InputState.releasedLastFrame.emplace(input);
+		isDown = false;
 		// NOTE: not a bug! bitmap not reset here but after next update via `justReleased`!
 	}
 }
 
-void InputSystem::OnMouseEvent(MouseEvent input_)
+void InputSystem::DrainEvents()
 {
-	UInt32 button = (UInt64)input_.button;
+	m_InputState.events.clear();
+	m_InputState.heldBeforeRelease.clear();
 
-	if (input_.action == EDaggerInputState::Pressed)
+	InputEvent event;
+	while (m_Queue.Pop(event))
 	{
-		m_InputState.mouse[button - MouseStart] = true;
-		m_InputState.moments[button] = std::chrono::steady_clock::now();
-		m_InputState.bitmap.set(button);
+		m_InputState.events.push_back(event);
 	}
-	else if (input_.action == EDaggerInputState::Released)
+
+	const UInt32 dropped = m_Queue.Dropped();
+	if (dropped != m_DroppedEvents)
 	{
-		m_InputState.releasedLastFrame.emplace(button);
-		m_InputState.mouse[button - MouseStart] = false;
-		m_InputState.moments.erase(button);
-		// NOTE: not a bug! bitmap not reset here but after next update via `justReleased`!
+		Logger::warn("Input queue is full, {} events dropped so far", dropped);
+		m_DroppedEvents = dropped;
 	}
 }
 
-void InputSystem::OnCursorMoveEvent(CursorEvent cursor_)
+void InputSystem::PlayBackFrame()
 {
-	m_InputState.cursor = cursor_;
+	// queued live input is dropped, so InputState only sees the recording. The dispatcher's KeyboardEvent and
+	// MouseEvent stay live, which is why gameplay that should replay reads InputState instead.
+	m_InputState.events.clear();
+
+	if (!m_Replay.Next(m_ReplayFrame))
+	{
+		Logger::info("Input replay finished");
+		m_Replay.Close();
+		Engine::Dispatcher().trigger<Exit>();
+		return;
+	}
+
+	// the recorded delta time of this frame is how long the previous one took when it was recorded
+	const TimePoint frameStart = TimeSnapshot();
+	if (m_ReplayFrameStart != TimePoint {})
+	{
+		m_ReplayTimings.push_back(
+			ReplayTiming {m_ReplayFrame.deltaTime, Duration {frameStart - m_ReplayFrameStart}.count()});
+	}
+	m_ReplayFrameStart = frameStart;
+
+	Engine::OverrideFrameTime(m_ReplayFrame.now, m_ReplayFrame.deltaTime);
+	std::swap(m_InputState.events, m_ReplayFrame.events);
+}
+
+void InputSystem::WriteReplayTimings()
+{
+	if (m_ReplayTimings.empty())
+		return;
+
+	std::ofstream output {m_ReplayTimingsPath, std::ios::trunc};
+	if (!output.is_open())
+	{
+		Logger::warn("Couldn't write replay timings to '{}'", m_ReplayTimingsPath);
+		return;
+	}
+
+	Float32 total = 0.0f;
+	Float32 worst = 0.0f;
+	output << "frame,recorded_ms,measured_ms\n";
+	for (UInt32 i = 0; i < m_ReplayTimings.size(); i++)
+	{
+		const auto& timing = m_ReplayTimings[i];
+		output << fmt::format("{},{:.3f},{:.3f}\n", i + 1, timing.recorded * 1000.0f, timing.measured * 1000.0f);
+		total += timing.measured;
+		worst = std::max(worst, timing.measured);
+	}
+
+	Logger::info(
+		"Replayed {} frames: {:.3f} ms on average, {:.3f} ms at worst, written to '{}'", m_ReplayTimings.size(),
+		total * 1000.0f / m_ReplayTimings.size(), worst * 1000.0f, m_ReplayTimingsPath);
 }
 
 void InputSystem::SpinUp()
 {
 	Engine::Dispatcher().sink<AssetLoadRequest<InputContext>>().connect<&InputSystem::OnAssetLoadRequest>(this);
-	Engine::Dispatcher().sink<KeyboardEvent>().connect<&InputSystem::OnKeyboardEvent>(this);
-	Engine::Dispatcher().sink<MouseEvent>().connect<&InputSystem::OnMouseEvent>(this);
-	Engine::Dispatcher().sink<CursorEvent>().connect<&InputSystem::OnCursorMoveEvent>(this);
 
 	Engine::PutDefaultResource<InputState>(&m_InputState);
+	Engine::PutDefaultResource<InputEventQueue>(&m_Queue);
+
+	auto& ini = Engine::GetIniFile();
+	const String replayPath = ini.GetValue("input", "replay", "");
+	const String recordPath = ini.GetValue("input", "record", "");
+	m_ReplayTimingsPath = ini.GetValue("input", "replay-timings", "replay-timings.csv");
+
+	if (!replayPath.empty())
+	{
+		if (!m_Replay.Open(replayPath))
+		{
+			Engine::Dispatcher().trigger<Error>(Error {fmt::format("Couldn't open input replay '{}'.", replayPath)});
+			return;
+		}
+
+		// gameplay systems spin up after this one, so their random streams come from the recorded seed
+		Random::Seed(m_Replay.Seed());
+		Logger::info("Replaying input from '{}'", replayPath);
+	}
+
+	if (!recordPath.empty())
+	{
+		if (!m_Recorder.Open(recordPath, Random::MasterSeed()))
+		{
+			Engine::Dispatcher().trigger<Error>(Error {fmt::format("Couldn't open '{}' to record input.", recordPath)});
+			return;
+		}
+
+		Logger::info("Recording input to '{}'", recordPath);
+	}
 
 	LoadDefaultAssets();
 };
@@ -159,6 +307,7 @@ void InputSystem::OnAssetLoadRequest(AssetLoadRequest<InputContext> request_)
 		InputCommand command;
 		assert(cmd.contains("command-name"));
 		command.name = cmd["command-name"];
+		command.id = InputCommands::Id(command.name);
 
 		if (cmd.contains("actions"))
 		{
@@ -187,6 +336,7 @@ void InputSystem::OnAssetLoadRequest(AssetLoadRequest<InputContext> request_)
 	}
 
 	library[context->name] = context;
+	m_LibraryVersion++;
 	Logger::info("Input context '{}' loaded!", context->name);
 }
 
@@ -256,70 +406,96 @@ Bool InputSystem::ProcessInputAction(InputAction& action_)
 	}
 }
 
-void InputSystem::ProcessContext(InputContext* context_, InputReceiver& receiver_, Set<String>& updatedCommands_)
+void InputSystem::ProcessContext(InputContext* context_, InputReceiver& receiver_)
 {
 	for (auto& command : context_->commands)
 	{
-		String fullName = command.name;
+		Bool isFired = false;
+		Float32 value = 0.0f;
+
 		for (auto& action : command.actions)
 		{
 			if (action.event == EDaggerInputState::Released)
 			{
 				if (m_InputState.releasedLastFrame.contains(action.trigger))
 				{
-					receiver_.values[fullName] = action.value;
-					updatedCommands_.emplace(fullName);
+					value = action.value;
+					isFired = true;
 				}
 			}
-			else
+			// If the action trigger is active set the appropriate value
+			else if (ProcessInputAction(action))
 			{
-				if (m_InputState.releasedLastFrame.contains(action.trigger))
-				{
-					receiver_.values[fullName] = 0;
-				}
-
-				// If the action trigger is active set the appropriate value
-				if (ProcessInputAction(action))
-				{
-					receiver_.values[fullName] = action.value;
-					updatedCommands_.emplace(fullName);
-				}
+				value = action.value;
+				isFired = true;
 			}
 		}
+
+		if (isFired)
+		{
+			receiver_.values[command.id] = value;
+			receiver_.fired.push_back(command.id);
+		}
 	}
 }
 
+void InputSystem::ResolveContexts(InputReceiver& receiver_)
+{
+	auto& library = Engine::Res<InputContext>();
+
+	receiver_.resolved.clear();
+	for (auto& name : receiver_.contexts)
+	{
+		assert(library.contains(name));
+		receiver_.resolved.push_back(library[name]);
+	}
+	receiver_.resolvedVersion = m_LibraryVersion;
+	receiver_.resolvedContextsVersion = receiver_.contextsVersion;
+}
+
 void InputSystem::Run()
 {
+	DrainEvents();
+	if (m_Replay.IsOpen())
+		PlayBackFrame();
+
+	for (const auto& event : m_InputState.events)
+	{
+		ApplyEvent(event);
+	}
+
+	if (m_Recorder.IsOpen())
+		m_Recorder.Write(Engine::CurrentTime(), Engine::DeltaTime(), m_InputState.events);
+
+	const UInt32 commandCount = InputCommands::Count();
+
 	Engine::Registry().view<InputReceiver>().each(
 		[&](InputReceiver& receiver_)
 		{
-			static Set<String> updatedCommands {};
+			if (receiver_.resolvedVersion != m_LibraryVersion ||
+				receiver_.resolvedContextsVersion != receiver_.contextsVersion)
+				ResolveContexts(receiver_);
+
+			if (receiver_.values.size() < commandCount)
+				receiver_.values.resize(commandCount, 0.0f);
+
+			// commands hold their value only for the frame they fired in
+			for (UInt32 id : receiver_.fired)
+			{
+				receiver_.values[id] = 0.0f;
+			}
+			receiver_.fired.clear();
 
 			// Bit map of current inputs
-			auto& bitmap = m_InputState.bitmap;
-			// List of loaded input contexts
-			auto& library = Engine::Res<InputContext>();
+			const auto& bitmap = m_InputState.bitmap;
 			// Loop through every context the input receiver is listening
-			for (auto& name : receiver_.contexts)
+			for (auto* context : receiver_.resolved)
 			{
-				assert(library.contains(name));
-				const auto& context = library[name];
-				const auto& collision = (bitmap & context->bitmap);
 				// If any key used for the context is held or has changed state process the context again
-				if (collision.any())
+				if ((bitmap & context->bitmap).any())
 				{
-					ProcessContext(context, receiver_, updatedCommands);
+					ProcessContext(context, receiver_);
 				}
-
-				Map<String, Float32> newValues;
-				// Update the input context values
-				for (auto [key, value] : receiver_.values)
-				{
-					newValues[key] = updatedCommands.contains(key) ? value : 0.0f;
-				}
-				receiver_.values = newValues;
-				updatedCommands.clear();
 			}
 		});
 
@@ -338,9 +514,12 @@ void InputSystem::Run()
 void InputSystem::WindDown()
 {
 	Engine::Dispatcher().sink<AssetLoadRequest<InputContext>>().disconnect<&InputSystem::OnAssetLoadRequest>(this);
-	Engine::Dispatcher().sink<KeyboardEvent>().disconnect<&InputSystem::OnKeyboardEvent>(this);
-	Engine::Dispatcher().sink<MouseEvent>().disconnect<&InputSystem::OnMouseEvent>(this);
-	Engine::Dispatcher().sink<CursorEvent>().disconnect<&InputSystem::OnCursorMoveEvent>(this);
+
+	Engine::PutDefaultResource<InputEventQueue>(nullptr);
+
+	m_Recorder.Close();
+	m_Replay.Close();
+	WriteReplayTimings();
 };
 
 Bool dagger::Input::IsInputDown(EDaggerKeyboard key_)
@@ -396,14 +575,33 @@ UInt32 dagger::Input::GetInputDuration(EDaggerKeyboard key_)
 		return 0;
 	}
 
-	return DurationToMilliseconds(Engine::CurrentTime() - state->moments.at(value));
+	return MillisecondsBetween(state->moments.at(value), Engine::CurrentTime());
 }
 
 UInt32 dagger::Input::GetInputDuration(EDaggerMouse mouse_)
 {
 	const auto* state = Engine::GetDefaultResource<InputState>();
 	auto value = (UInt32)mouse_;
-	return DurationToMilliseconds(Engine::CurrentTime() - state->moments.at(value));
+	if (!state->moments.contains(value))
+	{
+		return 0;
+	}
+
+	return MillisecondsBetween(state->moments.at(value), Engine::CurrentTime());
+}
+
+UInt32 dagger::Input::GetReleasedDuration(EDaggerKeyboard key_)
+{
+	const auto* state = Engine::GetDefaultResource<InputState>();
+	auto found = state->heldBeforeRelease.find((UInt32)key_);
+	return found != state->heldBeforeRelease.end() ? found->second : 0;
+}
+
+UInt32 dagger::Input::GetReleasedDuration(EDaggerMouse button_)
+{
+	const auto* state = Engine::GetDefaultResource<InputState>();
+	auto found = state->heldBeforeRelease.find((UInt32)button_);
+	return found != state->heldBeforeRelease.end() ? found->second : 0;
 }
 
 void dagger::Input::ConsumeInput(EDaggerKeyboard key_)
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "core/core.h"
+#include "core/input/input_queue.h"
+#include "core/input/input_recording.h"
 #include "core/system.h"
 
+#include <algorithm>
 #include <bitset>
 #include <functional>
 
@@ -19,9 +22,20 @@ namespace dagger
 		EDaggerInputState event {EDaggerInputState::Pressed};
 	};
 
+	// InputCommands: the ids command names resolve to, shared by every context that uses the same name.
+	// An id is handed out the first time its name is seen, by a context loading or by gameplay asking for it,
+	// and never changes; resolve names once and keep the id around.
+	struct InputCommands
+	{
+		static UInt32 Id(const String& name_);
+		static String Name(UInt32 id_);
+		static UInt32 Count();
+	};
+
 	struct InputCommand
 	{
 		String name;
+		UInt32 id {0};
 		Sequence<InputAction> actions;
 	};
 
@@ -35,15 +49,45 @@ namespace dagger
 
 	struct InputReceiver
 	{
+		// change through AddContext, RemoveContext or SetContexts so the receiver knows to resolve them again
 		Sequence<String> contexts;
-		Map<String, Float32> values;
+		UInt32 contextsVersion {0};
+
+		// command values indexed by id, and the ids that fired last frame
+		Sequence<Float32> values;
+		Sequence<UInt32> fired;
+
+		// contexts resolved from their names, redone whenever the library or the contexts change
+		Sequence<InputContext*> resolved;
+		UInt32 resolvedVersion {0};
+		UInt32 resolvedContextsVersion {0};
+
+		inline void AddContext(const String& name_)
+		{
+			contexts.push_back(name_);
+			contextsVersion++;
+		}
+
+		inline void RemoveContext(const String& name_)
+		{
+			contexts.erase(std::remove(contexts.begin(), contexts.end(), name_), contexts.end());
+			contextsVersion++;
+		}
 
-		inline Float32 Get(String name_)
+		inline void SetContexts(Sequence<String> contexts_)
 		{
-			if (!values.contains(name_))
-				values[name_] = 0.0f;
+			contexts = std::move(contexts_);
+			contextsVersion++;
+		}
+
+		inline Float32 Get(UInt32 command_) const
+		{
+			return command_ < values.size() ? values[command_] : 0.0f;
+		}
 
-			return values[name_];
+		inline Float32 Get(const String& name_) const
+		{
+			return Get(InputCommands::Id(name_));
 		}
 	};
 
@@ -59,6 +103,10 @@ namespace dagger
 		Set<UInt32> releasedLastFrame {};
 		// Map of input keys and times they were pressed. Only for currently pressed keys
 		Map<UInt32, TimePoint> moments {};
+		// How long inputs released since the last frame were held, in milliseconds
+		Map<UInt32, UInt32> heldBeforeRelease {};
+		// Every input event since the last frame, in the order they happened
+		Sequence<InputEvent> events {};
 		// Bitmap indicating all changed inputs including just released keys
 		BitSet<InputCount> bitmap;
 
@@ -203,16 +251,38 @@ namespace dagger
 
 		void LoadInputAction(InputCommand& command_, JSON::json& input_);
 
-		void OnKeyboardEvent(KeyboardEvent input_);
-		void OnMouseEvent(MouseEvent input_);
-		void OnCursorMoveEvent(CursorEvent cursor_);
+		void DrainEvents();
+		void ApplyEvent(const InputEvent& event_);
+		void PlayBackFrame();
+		void WriteReplayTimings();
 
 		Bool ProcessMouseAction(InputAction& action_);
 		Bool ProcessKeyboardAction(InputAction& action_);
 		Bool ProcessInputAction(InputAction& action_);
-		void ProcessContext(InputContext* context_, InputReceiver& receiver_, Set<String>& updatedCommands_);
+		void ProcessContext(InputContext* context_, InputReceiver& receiver_);
+		void ResolveContexts(InputReceiver& receiver_);
 
 		InputState m_InputState;
+		InputEventQueue m_Queue;
+		UInt32 m_DroppedEvents {0};
+
+		// [input] record and replay: the input of a run, with its seed and frame times, can be played back
+		// instead of live input, which makes any game mode a repeatable benchmark
+		struct ReplayTiming
+		{
+			Float32 recorded;
+			Float32 measured;
+		};
+
+		InputRecorder m_Recorder;
+		InputReplay m_Replay;
+		ReplayFrame m_ReplayFrame;
+		Sequence<ReplayTiming> m_ReplayTimings;
+		TimePoint m_ReplayFrameStart {};
+		String m_ReplayTimingsPath;
+
+		// bumped on every context load, so receivers know to look their contexts up again
+		UInt32 m_LibraryVersion {1};
 
 	public:
 		inline String SystemName() const override
@@ -239,6 +309,10 @@ namespace dagger
 		static UInt32 GetInputDuration(EDaggerKeyboard key_);
 		static UInt32 GetInputDuration(EDaggerMouse mouse_);
 
+		// how long an input released since the last frame had been held, 0 if it wasn't released
+		static UInt32 GetReleasedDuration(EDaggerKeyboard key_);
+		static UInt32 GetReleasedDuration(EDaggerMouse button_);
+
 		static void ConsumeInput(EDaggerKeyboard key_);
 		static void ConsumeInput(EDaggerMouse button_);
 	};
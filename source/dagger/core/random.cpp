@@ -0,0 +1,126 @@
+#include "random.h"
+
+#include <atomic>
+
+using namespace dagger;
+
+namespace
+{
+	std::atomic<UInt64> s_MasterSeed {0};
+	std::atomic<UInt32> s_SeedGeneration {0};
+	std::atomic<UInt32> s_NextThreadIndex {0};
+
+	// splitmix64, used to spread a single seed over the whole xoshiro state
+	UInt64 SplitMix(UInt64& state_)
+	{
+		UInt64 z = (state_ += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	UInt64 HashName(const String& name_)
+	{
+		UInt64 hash = 0xCBF29CE484222325ull;
+		for (Char c : name_)
+		{
+			hash ^= static_cast<UInt8>(c);
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	struct ThreadStream
+	{
+		RandomStream stream;
+		UInt32 index {s_NextThreadIndex++};
+		UInt32 generation {~0u};
+	};
+} // namespace
+
+RandomStream::RandomStream(UInt64 seed_)
+{
+	Seed(seed_);
+}
+
+void RandomStream::Seed(UInt64 seed_)
+{
+	UInt64 state = seed_;
+	const UInt64 a = SplitMix(state);
+	const UInt64 b = SplitMix(state);
+
+	m_State[0] = static_cast<UInt32>(a);
+	m_State[1] = static_cast<UInt32>(a >> 32);
+	m_State[2] = static_cast<UInt32>(b);
+	m_State[3] = static_cast<UInt32>(b >> 32);
+}
+
+void RandomStream::Fill(Float32* out_, UInt32 count_, Float32 min_, Float32 max_)
+{
+	const Float32 scale = (max_ - min_) * (1.0f / 16777216.0f);
+	for (UInt32 i = 0; i < count_; ++i)
+	{
+		out_[i] = min_ + (Next() >> 8) * scale;
+	}
+}
+
+void RandomStream::Fill(Vector2* out_, UInt32 count_, Vector2 min_, Vector2 max_)
+{
+	for (UInt32 i = 0; i < count_; ++i)
+	{
+		out_[i] = {Uniform(min_.x, max_.x), Uniform(min_.y, max_.y)};
+	}
+}
+
+void RandomStream::Fill(Vector3* out_, UInt32 count_, Vector3 min_, Vector3 max_)
+{
+	for (UInt32 i = 0; i < count_; ++i)
+	{
+		out_[i] = {Uniform(min_.x, max_.x), Uniform(min_.y, max_.y), Uniform(min_.z, max_.z)};
+	}
+}
+
+void RandomStream::Fill(Vector4* out_, UInt32 count_, Vector4 min_, Vector4 max_)
+{
+	for (UInt32 i = 0; i < count_; ++i)
+	{
+		out_[i] = {
+			Uniform(min_.x, max_.x), Uniform(min_.y, max_.y), Uniform(min_.z, max_.z), Uniform(min_.w, max_.w)};
+	}
+}
+
+void Random::Seed(UInt64 seed_)
+{
+	if (seed_ == 0)
+	{
+		seed_ = static_cast<UInt64>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+	}
+
+	s_MasterSeed = seed_;
+	s_SeedGeneration++;
+}
+
+UInt64 Random::MasterSeed()
+{
+	return s_MasterSeed;
+}
+
+RandomStream& Random::Thread()
+{
+	thread_local ThreadStream local;
+
+	const UInt32 generation = s_SeedGeneration;
+	if (local.generation != generation)
+	{
+		UInt64 indexState = local.index;
+		local.stream.Seed(s_MasterSeed ^ SplitMix(indexState));
+		local.generation = generation;
+	}
+
+	return local.stream;
+}
+
+RandomStream Random::Stream(const String& name_)
+{
+	return RandomStream {s_MasterSeed ^ HashName(name_)};
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/core.h"
+
+namespace dagger
+{
+	// RandomStream: a xoshiro128+ generator. Cheap to copy and free of shared state,
+	// so every system or thread can own one instead of contending over rand().
+	class RandomStream
+	{
+		StaticArray<UInt32, 4> m_State {};
+
+	public:
+		RandomStream() = default;
+		explicit RandomStream(UInt64 seed_);
+
+		void Seed(UInt64 seed_);
+
+		inline UInt32 Next()
+		{
+			const UInt32 result = m_State[0] + m_State[3];
+			const UInt32 shifted = m_State[1] << 9;
+
+			m_State[2] ^= m_State[0];
+			m_State[3] ^= m_State[1];
+			m_State[1] ^= m_State[2];
+			m_State[0] ^= m_State[3];
+			m_State[2] ^= shifted;
+			m_State[3] = (m_State[3] << 11) | (m_State[3] >> 21);
+
+			return result;
+		}
+
+		// Uniform float in [0, 1), built from the upper 24 bits (the lower bits of xoshiro128+ are weaker).
+		inline Float32 Uniform()
+		{
+			return (Next() >> 8) * (1.0f / 16777216.0f);
+		}
+
+		inline Float32 Uniform(Float32 min_, Float32 max_)
+		{
+			return min_ + (max_ - min_) * Uniform();
+		}
+
+		// Integer in [min_, max_], both inclusive.
+		inline SInt32 Range(SInt32 min_, SInt32 max_)
+		{
+			const UInt64 span = static_cast<UInt64>(static_cast<SInt64>(max_) - min_ + 1);
+			return static_cast<SInt32>(min_ + static_cast<SInt64>((Next() * span) >> 32));
+		}
+
+		// Either -1 or 1.
+		inline SInt32 Sign()
+		{
+			return (Next() >> 31) ? 1 : -1;
+		}
+
+		void Fill(Float32* out_, UInt32 count_, Float32 min_ = 0.0f, Float32 max_ = 1.0f);
+		void Fill(Vector2* out_, UInt32 count_, Vector2 min_, Vector2 max_);
+		void Fill(Vector3* out_, UInt32 count_, Vector3 min_, Vector3 max_);
+		void Fill(Vector4* out_, UInt32 count_, Vector4 min_, Vector4 max_);
+	};
+
+	// Random: engine-wide seeding and access to random streams.
+	// The master seed comes from [engine] seed in the ini; 0 (the default) picks one from the clock.
+	struct Random
+	{
+		static void Seed(UInt64 seed_);
+
+		static UInt64 MasterSeed();
+
+		// A stream owned by the calling thread. Threads are numbered in order of first use,
+		// so results only repeat between runs when threads start up in the same order.
+		static RandomStream& Thread();
+
+		// A fresh stream derived from the master seed and a name. Systems keep one of these
+		// so their sequence does not depend on who else drew numbers this frame.
+		static RandomStream Stream(const String& name_);
+	};
+} // namespace dagger
@@ -120,6 +120,9 @@ JSON::json SerializeComponent(SimpleCollision& input_)
 	JSON::json save {};
 	save["size"] = SerializeComponent(input_.size);
 	save["pivot"] = SerializeComponent(input_.pivot);
+	save["layer"] = input_.layer;
+	save["mask"] = input_.mask;
+	save["static"] = input_.isStatic;
 	return save;
 }
 
@@ -128,6 +131,11 @@ void DeserializeComponent(JSON::json input_, SimpleCollision& fill_)
 {
 	DeserializeComponent(input_["size"], fill_.size);
 	DeserializeComponent(input_["pivot"], fill_.pivot);
+
+	// older saves have none of these
+	fill_.layer = input_.value("layer", fill_.layer);
+	fill_.mask = input_.value("mask", fill_.mask);
+	fill_.isStatic = input_.value("static", fill_.isStatic);
 }
 
 // Serialize camera
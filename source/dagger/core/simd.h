@@ -0,0 +1,11 @@
+#pragma once
+
+// DAGGER_SSE or DAGGER_NEON is defined when the target has that 128-bit vector unit, with its intrinsics included.
+// Code using them keeps a scalar path for when neither is.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define DAGGER_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#define DAGGER_NEON
+#include <arm_neon.h>
+#endif // defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
@@ -0,0 +1,276 @@
+#include "aabb_tree.h"
+
+#include <algorithm>
+
+using namespace dagger;
+
+namespace
+{
+	// half the perimeter is enough to compare costs, and unlike area it doesn't vanish for flat boxes
+	Float32 HalfPerimeter(Vector2 min_, Vector2 max_)
+	{
+		return (max_.x - min_.x) + (max_.y - min_.y);
+	}
+
+	Bool Contains(Vector2 outerMin_, Vector2 outerMax_, Vector2 innerMin_, Vector2 innerMax_)
+	{
+		return outerMin_.x <= innerMin_.x && outerMin_.y <= innerMin_.y && innerMax_.x <= outerMax_.x &&
+			   innerMax_.y <= outerMax_.y;
+	}
+} // namespace
+
+SInt32 AABBTree::Allocate()
+{
+	if (m_FreeList == s_Null)
+	{
+		m_Nodes.emplace_back();
+		m_Nodes.back().height = 0;
+		return static_cast<SInt32>(m_Nodes.size()) - 1;
+	}
+
+	const SInt32 node = m_FreeList;
+	m_FreeList = m_Nodes[node].parent;
+	m_Nodes[node] = Node {};
+	m_Nodes[node].height = 0;
+	return node;
+}
+
+void AABBTree::Free(SInt32 node_)
+{
+	m_Nodes[node_].parent = m_FreeList;
+	m_Nodes[node_].height = -1;
+	m_FreeList = node_;
+}
+
+void AABBTree::Clear()
+{
+	m_Nodes.clear();
+	m_Root = s_Null;
+	m_FreeList = s_Null;
+	m_LeafCount = 0;
+}
+
+SInt32 AABBTree::Insert(Vector2 min_, Vector2 max_, UInt32 data_)
+{
+	const SInt32 proxy = Allocate();
+	auto& node = m_Nodes[proxy];
+	node.min = min_ - margin;
+	node.max = max_ + margin;
+	node.data = data_;
+
+	InsertLeaf(proxy);
+	m_LeafCount++;
+	return proxy;
+}
+
+void AABBTree::Remove(SInt32 proxy_)
+{
+	assert(m_Nodes[proxy_].IsLeaf());
+
+	RemoveLeaf(proxy_);
+	Free(proxy_);
+	m_LeafCount--;
+}
+
+Bool AABBTree::Move(SInt32 proxy_, Vector2 min_, Vector2 max_, Vector2 displacement_)
+{
+	auto& node = m_Nodes[proxy_];
+
+	// a leaf that grew far bigger than its box (after a fast move) is shrunk back as well
+	const Vector2 hugeMin = min_ - margin * 4.0f;
+	const Vector2 hugeMax = max_ + margin * 4.0f;
+	if (Contains(node.min, node.max, min_, max_) && Contains(hugeMin, hugeMax, node.min, node.max))
+		return false;
+
+	Vector2 fatMin = min_ - margin;
+	Vector2 fatMax = max_ + margin;
+
+	// expect it to keep going the same way
+	const Vector2 ahead = displacement_ * 2.0f;
+	for (SInt32 axis = 0; axis < 2; axis++)
+	{
+		if (ahead[axis] < 0)
+			fatMin[axis] += ahead[axis];
+		else
+			fatMax[axis] += ahead[axis];
+	}
+
+	RemoveLeaf(proxy_);
+	m_Nodes[proxy_].min = fatMin;
+	m_Nodes[proxy_].max = fatMax;
+	InsertLeaf(proxy_);
+	return true;
+}
+
+void AABBTree::InsertLeaf(SInt32 leaf_)
+{
+	if (m_Root == s_Null)
+	{
+		m_Root = leaf_;
+		m_Nodes[leaf_].parent = s_Null;
+		return;
+	}
+
+	const Vector2 leafMin = m_Nodes[leaf_].min;
+	const Vector2 leafMax = m_Nodes[leaf_].max;
+
+	// walk down to the sibling that makes the tree grow the least
+	SInt32 index = m_Root;
+	while (!m_Nodes[index].IsLeaf())
+	{
+		const auto& node = m_Nodes[index];
+		const Float32 area = HalfPerimeter(node.min, node.max);
+		const Float32 combined = HalfPerimeter(glm::min(node.min, leafMin), glm::max(node.max, leafMax));
+
+		// pairing with this node directly, against pushing the leaf further down
+		const Float32 cost = 2.0f * combined;
+		const Float32 inheritance = 2.0f * (combined - area);
+
+		const auto descendCost = [&](SInt32 child_)
+		{
+			const auto& child = m_Nodes[child_];
+			const Float32 grown = HalfPerimeter(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+			return (child.IsLeaf() ? grown : grown - HalfPerimeter(child.min, child.max)) + inheritance;
+		};
+
+		const Float32 leftCost = descendCost(node.left);
+		const Float32 rightCost = descendCost(node.right);
+
+		if (cost < leftCost && cost < rightCost)
+			break;
+
+		index = leftCost < rightCost ? node.left : node.right;
+	}
+
+	const SInt32 sibling = index;
+	const SInt32 oldParent = m_Nodes[sibling].parent;
+
+	// allocation may move the nodes, so nothing is held by reference across it
+	const SInt32 newParent = Allocate();
+	auto& parent = m_Nodes[newParent];
+	parent.parent = oldParent;
+	parent.min = glm::min(m_Nodes[sibling].min, leafMin);
+	parent.max = glm::max(m_Nodes[sibling].max, leafMax);
+	parent.height = m_Nodes[sibling].height + 1;
+	parent.left = sibling;
+	parent.right = leaf_;
+
+	if (oldParent == s_Null)
+		m_Root = newParent;
+	else if (m_Nodes[oldParent].left == sibling)
+		m_Nodes[oldParent].left = newParent;
+	else
+		m_Nodes[oldParent].right = newParent;
+
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf_].parent = newParent;
+
+	Refit(newParent);
+}
+
+void AABBTree::RemoveLeaf(SInt32 leaf_)
+{
+	if (leaf_ == m_Root)
+	{
+		m_Root = s_Null;
+		return;
+	}
+
+	const SInt32 parent = m_Nodes[leaf_].parent;
+	const SInt32 grandParent = m_Nodes[parent].parent;
+	const SInt32 sibling = m_Nodes[parent].left == leaf_ ? m_Nodes[parent].right : m_Nodes[parent].left;
+
+	// the sibling takes the parent's place
+	m_Nodes[sibling].parent = grandParent;
+	Free(parent);
+
+	if (grandParent == s_Null)
+	{
+		m_Root = sibling;
+		return;
+	}
+
+	if (m_Nodes[grandParent].left == parent)
+		m_Nodes[grandParent].left = sibling;
+	else
+		m_Nodes[grandParent].right = sibling;
+
+	Refit(grandParent);
+}
+
+void AABBTree::Refit(SInt32 node_)
+{
+	for (SInt32 index = node_; index != s_Null; index = m_Nodes[index].parent)
+	{
+		index = Balance(index);
+
+		auto& node = m_Nodes[index];
+		const auto& left = m_Nodes[node.left];
+		const auto& right = m_Nodes[node.right];
+
+		node.height = 1 + std::max(left.height, right.height);
+		node.min = glm::min(left.min, right.min);
+		node.max = glm::max(left.max, right.max);
+	}
+}
+
+SInt32 AABBTree::Balance(SInt32 node_)
+{
+	auto& a = m_Nodes[node_];
+	if (a.IsLeaf() || a.height < 2)
+		return node_;
+
+	const SInt32 indexB = a.left;
+	const SInt32 indexC = a.right;
+	auto& b = m_Nodes[indexB];
+	auto& c = m_Nodes[indexC];
+
+	const SInt32 balance = c.height - b.height;
+	if (balance >= -1 && balance <= 1)
+		return node_;
+
+	// the taller child takes a's place, a keeps the grandchild that best balances it
+	const SInt32 indexUp = balance > 1 ? indexC : indexB;
+	const SInt32 indexStays = balance > 1 ? indexB : indexC;
+	auto& up = m_Nodes[indexUp];
+	auto& stays = m_Nodes[indexStays];
+
+	const SInt32 indexF = up.left;
+	const SInt32 indexG = up.right;
+	auto& f = m_Nodes[indexF];
+	auto& g = m_Nodes[indexG];
+
+	up.left = node_;
+	up.parent = a.parent;
+	a.parent = indexUp;
+
+	if (up.parent == s_Null)
+		m_Root = indexUp;
+	else if (m_Nodes[up.parent].left == node_)
+		m_Nodes[up.parent].left = indexUp;
+	else
+		m_Nodes[up.parent].right = indexUp;
+
+	// the taller grandchild stays with the node that moved up
+	const SInt32 indexKept = f.height > g.height ? indexF : indexG;
+	const SInt32 indexGiven = f.height > g.height ? indexG : indexF;
+	auto& kept = m_Nodes[indexKept];
+	auto& given = m_Nodes[indexGiven];
+
+	up.right = indexKept;
+	if (balance > 1)
+		a.right = indexGiven;
+	else
+		a.left = indexGiven;
+	given.parent = node_;
+
+	a.min = glm::min(stays.min, given.min);
+	a.max = glm::max(stays.max, given.max);
+	a.height = 1 + std::max(stays.height, given.height);
+
+	up.min = glm::min(a.min, kept.min);
+	up.max = glm::max(a.max, kept.max);
+	up.height = 1 + std::max(a.height, kept.height);
+
+	return indexUp;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "core/core.h"
+
+#include <cassert>
+
+using namespace dagger;
+
+// AABBTree: a dynamic bounding volume hierarchy over boxes that live from frame to frame.
+// Leaves store fattened boxes, so a box that moves a little stays inside its leaf and costs nothing to update;
+// only boxes that leave their leaf are reinserted. Rotations keep sibling heights within one of each other.
+class AABBTree
+{
+public:
+	constexpr static SInt32 s_Null = -1;
+
+private:
+	struct Node
+	{
+		Vector2 min {0, 0};
+		Vector2 max {0, 0};
+		UInt32 data {0};
+
+		// next free node while the node is unused
+		SInt32 parent {s_Null};
+		SInt32 left {s_Null};
+		SInt32 right {s_Null};
+
+		// 0 for leaves, -1 for free nodes
+		SInt32 height {-1};
+
+		inline Bool IsLeaf() const
+		{
+			return left == s_Null;
+		}
+	};
+
+	Sequence<Node> m_Nodes;
+	SInt32 m_Root {s_Null};
+	SInt32 m_FreeList {s_Null};
+	UInt32 m_LeafCount {0};
+
+	SInt32 Allocate();
+	void Free(SInt32 node_);
+
+	void InsertLeaf(SInt32 leaf_);
+	void RemoveLeaf(SInt32 leaf_);
+
+	// fixes boxes and heights from node_ up to the root, rotating where needed
+	void Refit(SInt32 node_);
+	SInt32 Balance(SInt32 node_);
+
+public:
+	// how far a leaf reaches past the box it holds, in world units
+	Float32 margin {4.0f};
+
+	void Clear();
+
+	// returns the proxy that refers to this box until it is removed
+	SInt32 Insert(Vector2 min_, Vector2 max_, UInt32 data_);
+	void Remove(SInt32 proxy_);
+
+	// true if the box left its leaf and was reinserted; displacement_ stretches the new leaf the way it moves
+	Bool Move(SInt32 proxy_, Vector2 min_, Vector2 max_, Vector2 displacement_);
+
+	inline UInt32 Data(SInt32 proxy_) const
+	{
+		return m_Nodes[proxy_].data;
+	}
+
+	inline void SetData(SInt32 proxy_, UInt32 data_)
+	{
+		m_Nodes[proxy_].data = data_;
+	}
+
+	inline UInt32 Size() const
+	{
+		return m_LeafCount;
+	}
+
+	inline SInt32 Height() const
+	{
+		return m_Root == s_Null ? 0 : m_Nodes[m_Root].height;
+	}
+
+	// calls visit_(proxy) for every leaf whose fattened box overlaps the given box
+	template<typename Visit>
+	void Query(Vector2 min_, Vector2 max_, Visit&& visit_) const
+	{
+		// a balanced tree never gets deep enough to fill this
+		StaticArray<SInt32, 64> stack;
+		UInt32 top = 0;
+
+		if (m_Root != s_Null)
+			stack[top++] = m_Root;
+
+		while (top > 0)
+		{
+			const Node& node = m_Nodes[stack[--top]];
+			if (node.min.x > max_.x || node.max.x < min_.x || node.min.y > max_.y || node.max.y < min_.y)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				visit_(stack[top]);
+				continue;
+			}
+
+			assert(top + 2 <= stack.size());
+			stack[top++] = node.left;
+			stack[top++] = node.right;
+		}
+	}
+};
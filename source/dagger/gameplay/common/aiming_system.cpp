@@ -9,10 +9,12 @@
 
 void AimingSystem::Run()
 {
+	static const UInt32 s_RotateCommand = InputCommands::Id("rotate");
+
 	// The sprite component with the same entity as this crosshair component is of a sprite that is used for center of
 	// rotation (like character for example)
 	Engine::Registry().view<InputReceiver, Sprite, Crosshair>().each(
-		[](InputReceiver input_, Sprite& sprite_, Crosshair& crosshair_)
+		[](const InputReceiver& input_, Sprite& sprite_, Crosshair& crosshair_)
 		{
 			/*
 			Example setup of for "rotate" command in input-context :
@@ -28,8 +30,8 @@ void AimingSystem::Run()
 					}
 				]
 			*/
-			Float32 rotate = input_.Get("rotate"); // Get the input value of the rotate command - the amount the angle
-												   // changes if the button is pressed
+			// Get the input value of the rotate command - the amount the angle changes if the button is pressed
+			Float32 rotate = input_.Get(s_RotateCommand);
 
 			if (rotate != 0.0f)
 			{
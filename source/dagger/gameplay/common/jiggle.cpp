@@ -6,16 +6,21 @@
 
 using namespace dagger;
 
+void JiggleSystem::SpinUp()
+{
+	m_Random = Random::Stream(SystemName());
+}
+
 void JiggleSystem::Run()
 {
 	Engine::Registry().view<Sprite>().each(
 		[&](Sprite& sprite_)
 		{
-			sprite_.position.x += ((rand() % 3) - 1) * 0.001f;
-			sprite_.position.y += ((rand() % 3) - 1) * 0.001f;
+			sprite_.position.x += m_Random.Range(-1, 1) * 0.001f;
+			sprite_.position.y += m_Random.Range(-1, 1) * 0.001f;
 
-			sprite_.color.r += ((rand() % 3) - 1) * 0.01f;
-			sprite_.color.g += ((rand() % 3) - 1) * 0.01f;
-			sprite_.color.b += ((rand() % 3) - 1) * 0.01f;
+			sprite_.color.r += m_Random.Range(-1, 1) * 0.01f;
+			sprite_.color.g += m_Random.Range(-1, 1) * 0.01f;
+			sprite_.color.b += m_Random.Range(-1, 1) * 0.01f;
 		});
 }
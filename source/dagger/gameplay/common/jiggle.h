@@ -1,16 +1,20 @@
 #pragma once
 
 #include "core/core.h"
+#include "core/random.h"
 #include "core/system.h"
 
 using namespace dagger;
 
 class JiggleSystem : public System
 {
+	RandomStream m_Random;
+
 	inline String SystemName() const override
 	{
 		return "Jiggle System";
 	}
 
+	void SpinUp() override;
 	void Run() override;
 };
\ No newline at end of file
@@ -3,115 +3,251 @@
 #include "core/engine.h"
 #include "core/game/transforms.h"
 #include "core/graphics/sprite.h"
+#include "core/simd.h"
+
+#include <algorithm>
 
 using namespace dagger;
 using namespace common_res;
 
-void ParticleSystem::SetupParticleSystem(Entity entity_, const ParticleSpawnerSettings& settings_)
+using EAttribute = ParticlePool::EAttribute;
+
+void ParticlePool::Reserve(UInt32 capacity_)
 {
-	auto& reg = Engine::Registry();
-	auto& particleSys = reg.emplace<ParticleSpawner>(entity_);
-	particleSys.settings = settings_;
+	capacity = capacity_;
+	count = std::min(count, capacity);
+
+	for (auto& attribute : attributes)
+	{
+		attribute.resize(capacity);
+	}
 }
 
-// Get rand float value from 0 to 1
-Float32 ParticleGetRand()
+void ParticlePool::Kill(UInt32 index_)
 {
-	return ((double)rand() / (RAND_MAX));
+	assert(index_ < count);
+
+	// the last particle takes the dead one's slot, so the live range stays contiguous
+	count--;
+	for (auto& attribute : attributes)
+	{
+		attribute[index_] = attribute[count];
+	}
 }
 
-void ParticleSystem::CreateParticle(const ParticleSpawnerSettings& settings_, Vector3 pos_)
+// values_[i] += speeds_[i]
+static void Accumulate(Float32* values_, const Float32* speeds_, UInt32 count_)
+{
+	UInt32 i = 0;
+#if defined(DAGGER_SSE)
+	for (; i + 4 <= count_; i += 4)
+	{
+		_mm_storeu_ps(values_ + i, _mm_add_ps(_mm_loadu_ps(values_ + i), _mm_loadu_ps(speeds_ + i)));
+	}
+#elif defined(DAGGER_NEON)
+	for (; i + 4 <= count_; i += 4)
+	{
+		vst1q_f32(values_ + i, vaddq_f32(vld1q_f32(values_ + i), vld1q_f32(speeds_ + i)));
+	}
+#endif // defined(DAGGER_SSE)
+	for (; i < count_; i++)
+	{
+		values_[i] += speeds_[i];
+	}
+}
+
+// values_[i] += speed_
+static void Accumulate(Float32* values_, Float32 speed_, UInt32 count_)
+{
+	UInt32 i = 0;
+#if defined(DAGGER_SSE)
+	const __m128 speed = _mm_set1_ps(speed_);
+	for (; i + 4 <= count_; i += 4)
+	{
+		_mm_storeu_ps(values_ + i, _mm_add_ps(_mm_loadu_ps(values_ + i), speed));
+	}
+#elif defined(DAGGER_NEON)
+	const float32x4_t speed = vdupq_n_f32(speed_);
+	for (; i + 4 <= count_; i += 4)
+	{
+		vst1q_f32(values_ + i, vaddq_f32(vld1q_f32(values_ + i), speed));
+	}
+#endif // defined(DAGGER_SSE)
+	for (; i < count_; i++)
+	{
+		values_[i] += speed_;
+	}
+}
+
+void ParticleSystem::SetupParticleSystem(Entity entity_, const ParticleSpawnerSettings& settings_)
 {
 	auto& reg = Engine::Registry();
-	auto entity = reg.create();
+	auto& particleSys = reg.emplace<ParticleSpawner>(entity_);
+	particleSys.settings = settings_;
 
-	auto& sprite = reg.emplace<Sprite>(entity);
+	// resolved once here instead of once per particle
+	Sprite sprite;
 	AssignSprite(sprite, settings_.pSpriteName);
-	sprite.size = settings_.pSize;
+	particleSys.cutout = sprite;
 
-	Vector4 randColorVal;
-	randColorVal.r = glm::mix(settings_.pColorMin.r, settings_.pColorMax.r, ParticleGetRand());
-	randColorVal.g = glm::mix(settings_.pColorMin.g, settings_.pColorMax.g, ParticleGetRand());
-	randColorVal.b = glm::mix(settings_.pColorMin.b, settings_.pColorMax.b, ParticleGetRand());
-	randColorVal.a = glm::mix(settings_.pColorMin.a, settings_.pColorMax.a, ParticleGetRand());
-	sprite.color = randColorVal;
-
-	auto& transform = reg.emplace<Transform>(entity);
-	transform.position = pos_;
+	if (settings_.simulateOnGPU)
+	{
+		auto& emitter = reg.get_or_emplace<GPUParticleEmitter>(entity_);
+		emitter.image = sprite.image;
+		emitter.cutout = sprite;
+		emitter.colorSpeed = settings_.pColorSpeed;
+		emitter.capacity = settings_.capacity;
+		return;
+	}
 
-	auto& particle = reg.emplace<Particle>(entity);
+	particleSys.pool.Reserve(settings_.capacity);
 
-	Vector2 randSpeedVal;
-	randSpeedVal.x = glm::mix(settings_.pSpeedMin.x, settings_.pSpeedMax.x, ParticleGetRand());
-	randSpeedVal.y = glm::mix(settings_.pSpeedMin.y, settings_.pSpeedMax.y, ParticleGetRand());
-	particle.positionSpeed = {randSpeedVal.x, randSpeedVal.y, 0.f};
+	auto& batch = reg.get_or_emplace<SpriteBatch>(entity_);
+	batch.image = sprite.image;
+	batch.instances.reserve(settings_.capacity);
+}
 
-	particle.colorSpeed = {0.f, 0.f, 0.f, -0.01f};
+GPUParticle ParticleSystem::RollParticle(const ParticleSpawnerSettings& settings_, Vector3 pos_)
+{
+	auto& random = Random::Thread();
+	const Float32 randAddition = 0.1f * random.Sign();
+
+	GPUParticle particle;
+	particle.position = {pos_.x, pos_.y};
+	particle.velocity = {
+		glm::mix(settings_.pSpeedMin.x, settings_.pSpeedMax.x, random.Uniform()),
+		glm::mix(settings_.pSpeedMin.y, settings_.pSpeedMax.y, random.Uniform())};
+	particle.size = settings_.pSize;
+	particle.sizeSpeed = settings_.pSize * randAddition;
+	particle.color = {
+		glm::mix(settings_.pColorMin.r, settings_.pColorMax.r, random.Uniform()),
+		glm::mix(settings_.pColorMin.g, settings_.pColorMax.g, random.Uniform()),
+		glm::mix(settings_.pColorMin.b, settings_.pColorMax.b, random.Uniform()),
+		glm::mix(settings_.pColorMin.a, settings_.pColorMax.a, random.Uniform())};
+	particle.timeOfLiving = settings_.pTimeOfLiving;
+	return particle;
+}
 
-	Float32 randAddition = 0.1f * (1 - 2 * (rand() % 2));
-	particle.scaleSpeed = settings_.pSize * randAddition;
+void ParticleSystem::SpawnParticle(ParticleSpawner& spawner_, Vector3 pos_)
+{
+	auto& pool = spawner_.pool;
+	if (pool.count == pool.capacity)
+		return;
+
+	const auto particle = RollParticle(spawner_.settings, pos_);
+	const UInt32 i = pool.count++;
+
+	pool[EAttribute::PositionX][i] = particle.position.x;
+	pool[EAttribute::PositionY][i] = particle.position.y;
+	pool[EAttribute::VelocityX][i] = particle.velocity.x;
+	pool[EAttribute::VelocityY][i] = particle.velocity.y;
+	pool[EAttribute::SizeX][i] = particle.size.x;
+	pool[EAttribute::SizeY][i] = particle.size.y;
+	pool[EAttribute::SizeSpeedX][i] = particle.sizeSpeed.x;
+	pool[EAttribute::SizeSpeedY][i] = particle.sizeSpeed.y;
+	pool[EAttribute::ColorR][i] = particle.color.r;
+	pool[EAttribute::ColorG][i] = particle.color.g;
+	pool[EAttribute::ColorB][i] = particle.color.b;
+	pool[EAttribute::ColorA][i] = particle.color.a;
+	pool[EAttribute::TimeOfLiving][i] = particle.timeOfLiving;
 }
 
-void ParticleSystem::Run()
+void ParticleSystem::UpdateParticles(ParticleSpawner& spawner_)
 {
-	// Update all particle generators
+	auto& pool = spawner_.pool;
+	const auto& settings = spawner_.settings;
+	const UInt32 count = pool.count;
+
+	// speeds are per frame, lifetime is in seconds
+	Accumulate(pool[EAttribute::PositionX], pool[EAttribute::VelocityX], count);
+	Accumulate(pool[EAttribute::PositionY], pool[EAttribute::VelocityY], count);
+	Accumulate(pool[EAttribute::SizeX], pool[EAttribute::SizeSpeedX], count);
+	Accumulate(pool[EAttribute::SizeY], pool[EAttribute::SizeSpeedY], count);
+	Accumulate(pool[EAttribute::ColorR], settings.pColorSpeed.r, count);
+	Accumulate(pool[EAttribute::ColorG], settings.pColorSpeed.g, count);
+	Accumulate(pool[EAttribute::ColorB], settings.pColorSpeed.b, count);
+	Accumulate(pool[EAttribute::ColorA], settings.pColorSpeed.a, count);
+	Accumulate(pool[EAttribute::TimeOfLiving], -Engine::DeltaTime(), count);
+
+	const Float32* timeOfLiving = pool[EAttribute::TimeOfLiving];
+	for (UInt32 i = 0; i < pool.count;)
 	{
-		auto particles = Engine::Registry().view<ParticleSpawner, Transform>();
-
-		for (const auto& entity : particles)
-		{
-			auto& particleSys = particles.get<ParticleSpawner>(entity);
-			auto& t = particles.get<Transform>(entity);
-			if (particleSys.active)
-			{
-				particleSys.timer -= Engine::DeltaTime();
-				if (particleSys.timer < 0)
-				{
-					particleSys.timer = particleSys.settings.timeToNewParticle;
-
-					CreateParticle(particleSys.settings, t.position);
-				}
-			}
-		}
+		if (timeOfLiving[i] <= 0)
+			pool.Kill(i);
+		else
+			i++;
 	}
-
-	// Update all particles
-	Engine::Registry().view<Particle, Transform, Sprite>().each(
-		[&](Particle& particle_, Transform& transform_, Sprite& sprite_)
-		{
-			if (particle_.timeOfLiving > 0)
-			{
-				particle_.timeOfLiving -= Engine::DeltaTime();
-				transform_.position += particle_.positionSpeed;
-				sprite_.size += particle_.scaleSpeed;
-				// Might need to set color bounds
-				sprite_.color += particle_.colorSpeed;
-				// sprite_.color = glm::clamp(sprite_.color + particle_.colorSpeed, { 0, 0, 0, 0 }, { 1, 1, 1, 1 });
-			}
-		});
 }
 
-void ParticleSystem::SpinUp()
+void ParticleSystem::WriteInstances(const ParticleSpawner& spawner_, Float32 z_, SpriteBatch& batch_)
 {
-	Engine::Dispatcher().sink<NextFrame>().connect<&ParticleSystem::OnEndOfFrame>(this);
-}
+	const auto& pool = spawner_.pool;
+	const UInt32 count = pool.count;
 
-void ParticleSystem::WindDown()
-{
-	Engine::Dispatcher().sink<NextFrame>().disconnect<&ParticleSystem::OnEndOfFrame>(this);
+	batch_.instances.resize(count);
+	for (UInt32 i = 0; i < count; i++)
+	{
+		auto& instance = batch_.instances[i];
+		static_cast<SpriteCutoutData&>(instance) = spawner_.cutout;
+		instance.size = {pool[EAttribute::SizeX][i], pool[EAttribute::SizeY][i]};
+		instance.position = {pool[EAttribute::PositionX][i], pool[EAttribute::PositionY][i], z_};
+		instance.color = {
+			pool[EAttribute::ColorR][i], pool[EAttribute::ColorG][i], pool[EAttribute::ColorB][i],
+			pool[EAttribute::ColorA][i]};
+	}
 }
 
-void ParticleSystem::OnEndOfFrame()
+void ParticleSystem::Run()
 {
-	auto particles = Engine::Registry().view<Particle>();
+	auto& reg = Engine::Registry();
 
-	for (const auto& entity : particles)
+	// catches up on every particle that was due this frame, not just one, but never more than the pool holds
+	const auto spawnDue = [](ParticleSpawner& spawner_, auto&& spawn_)
 	{
-		auto& p = particles.get<Particle>(entity);
-		if (p.timeOfLiving <= 0)
+		if (!spawner_.active)
+			return;
+
+		// without a positive interval the timer would never catch up, so such spawners spawn once a frame
+		const Float32 interval = spawner_.settings.timeToNewParticle;
+		if (interval <= 0.0f)
 		{
-			Engine::Registry().destroy(entity);
-			Engine::Registry().create(entity);
+			spawn_();
+			return;
 		}
+
+		UInt32 budget = spawner_.settings.capacity;
+		spawner_.timer -= Engine::DeltaTime();
+		while (spawner_.timer < 0 && budget > 0)
+		{
+			spawner_.timer += interval;
+			spawn_();
+			budget--;
+		}
+
+		// a long hitch doesn't leave a debt to spawn over the following frames
+		spawner_.timer = std::max(spawner_.timer, 0.0f);
+	};
+
+	auto spawners = reg.view<ParticleSpawner, Transform, SpriteBatch>();
+	for (const auto& entity : spawners)
+	{
+		auto& particleSys = spawners.get<ParticleSpawner>(entity);
+		auto& t = spawners.get<Transform>(entity);
+
+		spawnDue(particleSys, [&]() { SpawnParticle(particleSys, t.position); });
+
+		UpdateParticles(particleSys);
+		WriteInstances(particleSys, t.position.z, spawners.get<SpriteBatch>(entity));
+	}
+
+	auto gpuSpawners = reg.view<ParticleSpawner, Transform, GPUParticleEmitter>();
+	for (const auto& entity : gpuSpawners)
+	{
+		auto& particleSys = gpuSpawners.get<ParticleSpawner>(entity);
+		auto& t = gpuSpawners.get<Transform>(entity);
+		auto& emitter = gpuSpawners.get<GPUParticleEmitter>(entity);
+
+		emitter.depth = t.position.z;
+		spawnDue(particleSys, [&]() { emitter.spawns.push_back(RollParticle(particleSys.settings, t.position)); });
 	}
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "core/core.h"
+#include "core/graphics/gpu_particles.h"
+#include "core/graphics/sprite.h"
 #include "core/system.h"
 
 using namespace dagger;
@@ -8,14 +10,6 @@ using namespace dagger;
 namespace common_res
 {
 
-	struct Particle
-	{
-		Vector2 scaleSpeed;
-		Vector3 positionSpeed;
-		Vector4 colorSpeed;
-		Float32 timeOfLiving = 1.f;
-	};
-
 	struct ParticleSpawnerSettings
 	{
 		Float32 timeToNewParticle = 1.f;
@@ -24,7 +18,12 @@ namespace common_res
 		Vector2 pSpeedMax;
 		ColorRGBA pColorMin {1.0f, 1.0f, 1.0f, 1.0f};
 		ColorRGBA pColorMax {1.0f, 1.0f, 1.0f, 1.0f};
+		ColorRGBA pColorSpeed {0.0f, 0.0f, 0.0f, -0.01f};
+		Float32 pTimeOfLiving = 1.f;
 		String pSpriteName;
+		UInt32 capacity = 1024;
+		// simulate and draw through GPUParticleSystem; the CPU then only rolls spawn parameters
+		Bool simulateOnGPU = false;
 
 		void Setup(
 			Float32 timeToNewParticle_, Vector2 pSize_, Vector2 pSpeedMin_, Vector2 pSpeedMax_,
@@ -41,6 +40,46 @@ namespace common_res
 		}
 	};
 
+	// ParticlePool: the live particles of one spawner, one array per attribute.
+	// Capacity is fixed when the spawner is set up; the first `count` slots are alive, in no particular order.
+	struct ParticlePool
+	{
+		enum class EAttribute : UInt32
+		{
+			PositionX,
+			PositionY,
+			VelocityX,
+			VelocityY,
+			SizeX,
+			SizeY,
+			SizeSpeedX,
+			SizeSpeedY,
+			ColorR,
+			ColorG,
+			ColorB,
+			ColorA,
+			TimeOfLiving,
+			AttributeCount
+		};
+
+		UInt32 capacity {0};
+		UInt32 count {0};
+		StaticArray<Sequence<Float32>, (UInt32)EAttribute::AttributeCount> attributes;
+
+		void Reserve(UInt32 capacity_);
+		void Kill(UInt32 index_);
+
+		inline Float32* operator[](EAttribute attribute_)
+		{
+			return attributes[(UInt32)attribute_].data();
+		}
+
+		inline const Float32* operator[](EAttribute attribute_) const
+		{
+			return attributes[(UInt32)attribute_].data();
+		}
+	};
+
 	class ParticleSystem : public System
 	{
 		inline String SystemName() const override
@@ -48,9 +87,7 @@ namespace common_res
 			return "Particle System";
 		}
 
-		void SpinUp() override;
 		void Run() override;
-		void WindDown() override;
 
 		struct ParticleSpawner
 		{
@@ -58,14 +95,17 @@ namespace common_res
 			Float32 timer = 0.f;
 
 			ParticleSpawnerSettings settings;
+			ParticlePool pool;
+			SpriteCutoutData cutout;
 		};
 
 	public:
 		static void SetupParticleSystem(Entity entity_, const ParticleSpawnerSettings& settings_);
 
 	private:
-		void OnEndOfFrame();
-
-		void CreateParticle(const ParticleSpawnerSettings& settings_, Vector3 pos_);
+		static GPUParticle RollParticle(const ParticleSpawnerSettings& settings_, Vector3 pos_);
+		static void SpawnParticle(ParticleSpawner& spawner_, Vector3 pos_);
+		static void UpdateParticles(ParticleSpawner& spawner_);
+		static void WriteInstances(const ParticleSpawner& spawner_, Float32 z_, SpriteBatch& batch_);
 	};
-} // namespace common_res
\ No newline at end of file
+} // namespace common_res
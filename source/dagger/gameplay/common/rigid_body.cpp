@@ -0,0 +1,307 @@
+#include "rigid_body.h"
+
+#include "core/engine.h"
+#include "core/game/transforms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <execution>
+#include <limits>
+#include <numeric>
+
+using namespace dagger;
+
+void RigidBodySystem::SpinUp()
+{
+	auto& ini = Engine::GetIniFile();
+	gravity.x = atof(ini.GetValue("physics", "gravity-x", "0"));
+	gravity.y = atof(ini.GetValue("physics", "gravity-y", "0"));
+	iterations = atoi(ini.GetValue("physics", "iterations", "8"));
+}
+
+void RigidBodySystem::Run()
+{
+	const Float32 deltaTime = Engine::DeltaTime();
+	if (deltaTime <= 0.0f)
+		return;
+
+	GatherBodies();
+	BuildConstraints();
+	BuildIslands();
+
+	// kinematic bodies only follow their velocity, and are done before the islands read it
+	for (auto& [entity, body, transform] : m_Bodies)
+	{
+		if (body->inverseMass == 0.0f)
+		{
+			transform->position.x += body->velocity.x * deltaTime;
+			transform->position.y += body->velocity.y * deltaTime;
+		}
+	}
+
+	std::for_each(
+		std::execution::par, m_Islands.begin(), m_Islands.begin() + m_IslandCount,
+		[this, deltaTime](Island& island_) { SolveIsland(island_, deltaTime); });
+}
+
+void RigidBodySystem::GatherBodies()
+{
+	m_Bodies.clear();
+	m_BodyIndex.clear();
+
+	// sleeping bodies stay out until something wakes them
+	auto view = Engine::Registry().view<RigidBody, Transform, SimpleCollision>();
+	for (auto entity : view)
+	{
+		auto& body = view.get<RigidBody>(entity);
+		if (!body.awake)
+			continue;
+
+		m_BodyIndex[entity] = m_Bodies.size();
+		m_Bodies.push_back(Body {entity, &body, &view.get<Transform>(entity)});
+	}
+}
+
+UInt32 RigidBodySystem::FindBody(Entity entity_, Bool wake_)
+{
+	auto found = m_BodyIndex.find(entity_);
+	if (found != m_BodyIndex.end())
+		return found->second;
+
+	if (!wake_)
+		return s_None;
+
+	auto& reg = Engine::Registry();
+	auto* body = reg.try_get<RigidBody>(entity_);
+	auto* transform = reg.try_get<Transform>(entity_);
+	if (body == nullptr || transform == nullptr)
+		return s_None;
+
+	body->Wake();
+	m_BodyIndex[entity_] = m_Bodies.size();
+	m_Bodies.push_back(Body {entity_, body, transform});
+	return m_Bodies.size() - 1;
+}
+
+Bool RigidBodySystem::IsDynamic(UInt32 body_) const
+{
+	return body_ != s_None && m_Bodies[body_].body->inverseMass > 0.0f;
+}
+
+void RigidBodySystem::BuildConstraints()
+{
+	m_Constraints.clear();
+
+	auto* collisions = Engine::GetDefaultResource<SimpleCollisionsSystem>();
+	if (collisions == nullptr)
+		return;
+
+	const auto velocityOf = [this](UInt32 body_)
+	{ return body_ == s_None ? Vector2 {0, 0} : m_Bodies[body_].body->velocity; };
+
+	for (const auto& contact : collisions->Contacts())
+	{
+		UInt32 a = FindBody(contact.a, false);
+		UInt32 b = FindBody(contact.b, false);
+
+		// anything awake and moving wakes a sleeping body it runs into
+		if (a == s_None && b != s_None && (IsDynamic(b) || velocityOf(b) != Vector2 {0, 0}))
+			a = FindBody(contact.a, true);
+		else if (b == s_None && a != s_None && (IsDynamic(a) || velocityOf(a) != Vector2 {0, 0}))
+			b = FindBody(contact.b, true);
+
+		if (!IsDynamic(a) && !IsDynamic(b))
+			continue;
+
+		const Float32 inverseMassA = a == s_None ? 0.0f : m_Bodies[a].body->inverseMass;
+		const Float32 inverseMassB = b == s_None ? 0.0f : m_Bodies[b].body->inverseMass;
+		const Float32 frictionA = a == s_None ? 1.0f : m_Bodies[a].body->friction;
+		const Float32 frictionB = b == s_None ? 1.0f : m_Bodies[b].body->friction;
+		const Float32 restitution = std::max(
+			a == s_None ? 0.0f : m_Bodies[a].body->restitution, b == s_None ? 0.0f : m_Bodies[b].body->restitution);
+
+		// sides are from a's point of view, so they point from a towards b
+		Constraint constraint;
+		constraint.a = a;
+		constraint.b = b;
+		constraint.normal = contact.sides;
+		constraint.penetration = contact.penetration;
+		constraint.normalMass = 1.0f / (inverseMassA + inverseMassB);
+		constraint.friction = std::sqrt(frictionA * frictionB);
+		constraint.normalImpulse = 0.0f;
+		constraint.tangentImpulse = 0.0f;
+
+		// bounce only off real impacts, resting contacts would jitter otherwise
+		const Float32 approach = glm::dot(velocityOf(b) - velocityOf(a), constraint.normal);
+		constraint.bounce = approach < -sleepSpeed ? -restitution * approach : 0.0f;
+
+		m_Constraints.push_back(constraint);
+	}
+}
+
+UInt32 RigidBodySystem::FindRoot(UInt32 body_)
+{
+	while (m_Parents[body_] != body_)
+	{
+		m_Parents[body_] = m_Parents[m_Parents[body_]];
+		body_ = m_Parents[body_];
+	}
+	return body_;
+}
+
+void RigidBodySystem::BuildIslands()
+{
+	const UInt32 count = m_Bodies.size();
+
+	// only dynamic bodies link islands; walls and kinematic bodies are shared by everything that touches them
+	m_Parents.resize(count);
+	std::iota(m_Parents.begin(), m_Parents.end(), 0);
+	for (const auto& constraint : m_Constraints)
+	{
+		if (IsDynamic(constraint.a) && IsDynamic(constraint.b))
+			m_Parents[FindRoot(constraint.a)] = FindRoot(constraint.b);
+	}
+
+	m_IslandOf.assign(count, s_None);
+	m_IslandCount = 0;
+	for (UInt32 i = 0; i < count; i++)
+	{
+		if (!IsDynamic(i))
+			continue;
+
+		const UInt32 root = FindRoot(i);
+		if (m_IslandOf[root] == s_None)
+		{
+			m_IslandOf[root] = m_IslandCount++;
+			if (m_Islands.size() < m_IslandCount)
+				m_Islands.emplace_back();
+
+			m_Islands[m_IslandOf[root]].bodies.clear();
+			m_Islands[m_IslandOf[root]].constraints.clear();
+		}
+
+		m_Islands[m_IslandOf[root]].bodies.push_back(i);
+	}
+
+	for (UInt32 c = 0; c < m_Constraints.size(); c++)
+	{
+		const auto& constraint = m_Constraints[c];
+		const UInt32 dynamic = IsDynamic(constraint.a) ? constraint.a : constraint.b;
+		m_Islands[m_IslandOf[FindRoot(dynamic)]].constraints.push_back(c);
+	}
+}
+
+void RigidBodySystem::SolveIsland(Island& island_, Float32 deltaTime_)
+{
+	// runs in parallel with other islands: only this island's bodies and constraints are written
+	static const Vector2 s_Still {0, 0};
+
+	const auto bodyOf = [this](UInt32 body_) { return IsDynamic(body_) ? m_Bodies[body_].body : nullptr; };
+
+	for (UInt32 i : island_.bodies)
+	{
+		auto& body = *m_Bodies[i].body;
+		body.velocity += gravity * body.gravityScale * deltaTime_;
+		body.velocity /= 1.0f + deltaTime_ * body.linearDamping;
+	}
+
+	for (UInt32 iteration = 0; iteration < iterations; iteration++)
+	{
+		for (UInt32 c : island_.constraints)
+		{
+			auto& constraint = m_Constraints[c];
+			auto* a = bodyOf(constraint.a);
+			auto* b = bodyOf(constraint.b);
+
+			// kinematic bodies are read, never pushed
+			const Vector2& velocityA = constraint.a == s_None ? s_Still : m_Bodies[constraint.a].body->velocity;
+			const Vector2& velocityB = constraint.b == s_None ? s_Still : m_Bodies[constraint.b].body->velocity;
+			const Float32 inverseMassA = a != nullptr ? a->inverseMass : 0.0f;
+			const Float32 inverseMassB = b != nullptr ? b->inverseMass : 0.0f;
+
+			// normal impulses only ever push apart, so the running total is kept non-negative
+			const Float32 normalSpeed = glm::dot(velocityB - velocityA, constraint.normal);
+			Float32 impulse = constraint.normalMass * (constraint.bounce - normalSpeed);
+			const Float32 normalTotal = std::max(constraint.normalImpulse + impulse, 0.0f);
+			impulse = normalTotal - constraint.normalImpulse;
+			constraint.normalImpulse = normalTotal;
+
+			Vector2 push = constraint.normal * impulse;
+			if (a != nullptr)
+				a->velocity -= push * inverseMassA;
+			if (b != nullptr)
+				b->velocity += push * inverseMassB;
+
+			// friction is bounded by how hard the bodies are pressed together
+			const Vector2 tangent {-constraint.normal.y, constraint.normal.x};
+			const Float32 tangentSpeed = glm::dot(velocityB - velocityA, tangent);
+			const Float32 limit = constraint.friction * constraint.normalImpulse;
+			const Float32 tangentTotal =
+				std::clamp(constraint.tangentImpulse - constraint.normalMass * tangentSpeed, -limit, limit);
+			impulse = tangentTotal - constraint.tangentImpulse;
+			constraint.tangentImpulse = tangentTotal;
+
+			push = tangent * impulse;
+			if (a != nullptr)
+				a->velocity -= push * inverseMassA;
+			if (b != nullptr)
+				b->velocity += push * inverseMassB;
+		}
+	}
+
+	for (UInt32 i : island_.bodies)
+	{
+		auto& position = m_Bodies[i].transform->position;
+		const auto& velocity = m_Bodies[i].body->velocity;
+		position.x += velocity.x * deltaTime_;
+		position.y += velocity.y * deltaTime_;
+	}
+
+	// overlap found by the collision pass is pushed out directly, so it never turns into speed
+	for (UInt32 c : island_.constraints)
+	{
+		const auto& constraint = m_Constraints[c];
+		const Float32 depth = std::max(constraint.penetration - allowedPenetration, 0.0f) * correction;
+		const Vector2 push = constraint.normal * depth * constraint.normalMass;
+
+		if (IsDynamic(constraint.a))
+		{
+			auto& position = m_Bodies[constraint.a].transform->position;
+			const Float32 inverseMass = m_Bodies[constraint.a].body->inverseMass;
+			position.x -= push.x * inverseMass;
+			position.y -= push.y * inverseMass;
+		}
+
+		if (IsDynamic(constraint.b))
+		{
+			auto& position = m_Bodies[constraint.b].transform->position;
+			const Float32 inverseMass = m_Bodies[constraint.b].body->inverseMass;
+			position.x += push.x * inverseMass;
+			position.y += push.y * inverseMass;
+		}
+	}
+
+	// the island sleeps only once every body in it has been resting long enough
+	Float32 restingTime = std::numeric_limits<Float32>::max();
+	for (UInt32 i : island_.bodies)
+	{
+		auto& body = *m_Bodies[i].body;
+		if (glm::dot(body.velocity, body.velocity) > sleepSpeed * sleepSpeed)
+			body.restingTime = 0.0f;
+		else
+			body.restingTime += deltaTime_;
+
+		restingTime = std::min(restingTime, body.restingTime);
+	}
+
+	if (restingTime < timeToSleep)
+		return;
+
+	for (UInt32 i : island_.bodies)
+	{
+		auto& body = *m_Bodies[i].body;
+		body.awake = false;
+		body.velocity = {0, 0};
+	}
+}
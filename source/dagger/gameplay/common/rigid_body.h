@@ -0,0 +1,103 @@
+#pragma once
+
+#include "core/core.h"
+#include "core/game/transforms.h"
+#include "core/system.h"
+#include "gameplay/common/simple_collisions.h"
+
+using namespace dagger;
+
+// RigidBody: lets a SimpleCollision move under its velocity and get pushed apart from whatever it touches.
+// Colliders without a body never move; a body with no inverse mass moves but is never pushed (kinematic).
+// A body that stays slow long enough falls asleep; call Wake() after changing the velocity of a sleeping body.
+struct RigidBody
+{
+	Vector2 velocity {0, 0};
+	Float32 inverseMass {1.0f};
+	Float32 restitution {0.0f};
+	Float32 friction {0.3f};
+	Float32 linearDamping {0.0f};
+	Float32 gravityScale {1.0f};
+
+	Bool awake {true};
+	Float32 restingTime {0.0f};
+
+	inline void Wake()
+	{
+		awake = true;
+		restingTime = 0.0f;
+	}
+};
+
+// RigidBodySystem: integrates awake bodies and resolves the contacts SimpleCollisionsSystem found this frame
+// with sequential impulses. Bodies that touch form islands; islands share no bodies, so they are solved in
+// parallel, and an island whose bodies all rest falls asleep as a whole. Runs after SimpleCollisionsSystem.
+// Reads [physics] gravity-x, gravity-y and iterations.
+class RigidBodySystem : public System
+{
+	constexpr static UInt32 s_None = ~0u;
+
+	struct Body
+	{
+		Entity entity;
+		RigidBody* body;
+		Transform* transform;
+	};
+
+	// one contact between two bodies, or a body and something immovable (s_None)
+	struct Constraint
+	{
+		UInt32 a;
+		UInt32 b;
+		Vector2 normal;
+		Float32 penetration;
+		Float32 normalMass;
+		Float32 friction;
+		Float32 bounce;
+		Float32 normalImpulse;
+		Float32 tangentImpulse;
+	};
+
+	struct Island
+	{
+		Sequence<UInt32> bodies;
+		Sequence<UInt32> constraints;
+	};
+
+	Sequence<Body> m_Bodies;
+	Map<Entity, UInt32> m_BodyIndex;
+	Sequence<Constraint> m_Constraints;
+	Sequence<UInt32> m_Parents;
+	Sequence<UInt32> m_IslandOf;
+	Sequence<Island> m_Islands;
+	UInt32 m_IslandCount {0};
+
+	void GatherBodies();
+	UInt32 FindBody(Entity entity_, Bool wake_);
+	void BuildConstraints();
+	void BuildIslands();
+	void SolveIsland(Island& island_, Float32 deltaTime_);
+
+	UInt32 FindRoot(UInt32 body_);
+	Bool IsDynamic(UInt32 body_) const;
+
+public:
+	Vector2 gravity {0, 0};
+	UInt32 iterations {8};
+
+	// bodies slower than this for timeToSleep seconds rest
+	Float32 sleepSpeed {1.0f};
+	Float32 timeToSleep {0.5f};
+
+	// overlap left alone so resting contacts persist, and how much of the rest is pushed out each frame
+	Float32 allowedPenetration {0.05f};
+	Float32 correction {0.8f};
+
+	inline String SystemName() const override
+	{
+		return "Rigid Body System";
+	}
+
+	void SpinUp() override;
+	void Run() override;
+};
@@ -2,39 +2,482 @@
 
 #include "core/engine.h"
 #include "core/game/transforms.h"
+#include "core/simd.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
 
 using namespace dagger;
 
+// four boxes, each edge read from its own contiguous array
+struct Edges4
+{
+	const Float32* left;
+	const Float32* right;
+	const Float32* bottom;
+	const Float32* top;
+};
+
+// hits_[k] = 1 if box k of a_ overlaps box k of b_, the same strict test as SimpleCollision::IsCollided
+static void Overlap4(const Edges4& a_, const Edges4& b_, UInt8* hits_)
+{
+#if defined(DAGGER_SSE)
+	const __m128 x = _mm_and_ps(
+		_mm_cmplt_ps(_mm_loadu_ps(a_.left), _mm_loadu_ps(b_.right)),
+		_mm_cmpgt_ps(_mm_loadu_ps(a_.right), _mm_loadu_ps(b_.left)));
+	const __m128 y = _mm_and_ps(
+		_mm_cmplt_ps(_mm_loadu_ps(a_.bottom), _mm_loadu_ps(b_.top)),
+		_mm_cmpgt_ps(_mm_loadu_ps(a_.top), _mm_loadu_ps(b_.bottom)));
+	const int mask = _mm_movemask_ps(_mm_and_ps(x, y));
+	for (UInt32 k = 0; k < 4; k++)
+	{
+		hits_[k] = (mask >> k) & 1;
+	}
+#elif defined(DAGGER_NEON)
+	const uint32x4_t x = vandq_u32(
+		vcltq_f32(vld1q_f32(a_.left), vld1q_f32(b_.right)), vcgtq_f32(vld1q_f32(a_.right), vld1q_f32(b_.left)));
+	const uint32x4_t y = vandq_u32(
+		vcltq_f32(vld1q_f32(a_.bottom), vld1q_f32(b_.top)), vcgtq_f32(vld1q_f32(a_.top), vld1q_f32(b_.bottom)));
+	UInt32 mask[4];
+	vst1q_u32(mask, vandq_u32(x, y));
+	for (UInt32 k = 0; k < 4; k++)
+	{
+		hits_[k] = mask[k] != 0;
+	}
+#else
+	for (UInt32 k = 0; k < 4; k++)
+	{
+		hits_[k] = a_.left[k] < b_.right[k] && a_.right[k] > b_.left[k] && a_.bottom[k] < b_.top[k] &&
+				   a_.top[k] > b_.bottom[k];
+	}
+#endif // defined(DAGGER_SSE)
+}
+
+// swept test of the box from start_ to end_ moving by displacement_ against a still one, the edges laid out as
+// SimpleCollision computes them; see SimpleCollision::GetTimeOfImpact
+static Bool TimeOfImpact(
+	Vector2 start_, Vector2 end_, Vector2 displacement_, Vector2 otherStart_, Vector2 otherEnd_, Float32& time_,
+	Vector2& normal_)
+{
+	Float32 entry = -std::numeric_limits<Float32>::infinity();
+	Float32 exit = std::numeric_limits<Float32>::infinity();
+	SInt32 entryAxis = -1;
+
+	// slab test per axis: when does this box start and stop overlapping the other one along it
+	for (SInt32 axis = 0; axis < 2; axis++)
+	{
+		const Float32 min = start_[axis];
+		const Float32 max = end_[axis];
+		const Float32 otherMin = otherStart_[axis];
+		const Float32 otherMax = otherEnd_[axis];
+
+		if (displacement_[axis] == 0)
+		{
+			if (max <= otherMin || min >= otherMax)
+				return false;
+			continue;
+		}
+
+		Float32 axisEntry = (displacement_[axis] > 0 ? otherMin - max : otherMax - min) / displacement_[axis];
+		Float32 axisExit = (displacement_[axis] > 0 ? otherMax - min : otherMin - max) / displacement_[axis];
+
+		if (axisEntry > entry)
+		{
+			entry = axisEntry;
+			entryAxis = axis;
+		}
+		exit = std::min(exit, axisExit);
+	}
+
+	if (entryAxis < 0 || entry >= exit || entry < 0 || entry > 1)
+		return false;
+
+	time_ = entry;
+	normal_ = {0, 0};
+	normal_[entryAxis] = displacement_[entryAxis] > 0 ? -1.0f : 1.0f;
+	return true;
+}
+
+void SimpleCollisionsSystem::SpinUp()
+{
+	const auto* mode = Engine::GetIniFile().GetValue("collisions", "broadphase", "true");
+	if (strcmp(mode, "false") == 0)
+		broadphase = ECollisionBroadphase::AllPairs;
+	else if (strcmp(mode, "tree") == 0)
+		broadphase = ECollisionBroadphase::Tree;
+	else
+		broadphase = ECollisionBroadphase::SweepAndPrune;
+
+	m_Tree.margin = atof(Engine::GetIniFile().GetValue("collisions", "tree-margin", "4"));
+}
+
 void SimpleCollisionsSystem::Run()
+{
+	GatherColliders();
+	m_IndexDirty = true;
+
+	std::swap(m_Contacts, m_PreviousContacts);
+	m_Contacts.clear();
+
+	switch (broadphase)
+	{
+	case ECollisionBroadphase::AllPairs:
+		RunAllPairs();
+		break;
+	case ECollisionBroadphase::SweepAndPrune:
+		RunSweepAndPrune();
+		break;
+	case ECollisionBroadphase::Tree:
+		RunTree();
+		break;
+	}
+
+	DispatchContactEvents();
+}
+
+void SimpleCollisionsSystem::GatherColliders()
 {
 	auto view = Engine::Registry().view<SimpleCollision, Transform>();
 
-	auto it = view.begin();
-	while (it != view.end())
+	m_Colliders.clear();
+	m_ColliderIndex.clear();
+	m_Bounds.left.clear();
+	m_Bounds.right.clear();
+	m_Bounds.bottom.clear();
+	m_Bounds.top.clear();
+
+	for (auto entity : view)
+	{
+		auto& collision = view.get<SimpleCollision>(entity);
+		auto& transform = view.get<Transform>(entity);
+
+		// computed exactly as IsCollided does, so the batched tests agree with it bit for bit
+		const Float32 left = transform.position.x + collision.pivot.x * collision.size.x;
+		const Float32 right = left + collision.size.x;
+		const Float32 bottom = transform.position.y + collision.pivot.y * collision.size.y;
+		const Float32 top = bottom + collision.size.y;
+
+		m_ColliderIndex.emplace(entity, (UInt32)m_Colliders.size());
+		m_Colliders.push_back(Collider {
+			entity, &collision, &transform, std::min(left, right), std::max(left, right), collision.layer,
+			collision.mask, collision.isStatic});
+		m_Bounds.left.push_back(left);
+		m_Bounds.right.push_back(right);
+		m_Bounds.bottom.push_back(bottom);
+		m_Bounds.top.push_back(top);
+	}
+}
+
+const SpatialIndex& SimpleCollisionsSystem::Index()
+{
+	if (m_IndexDirty)
+	{
+		m_Index.Clear();
+		for (UInt32 i = 0; i < m_Colliders.size(); i++)
+		{
+			const auto& collider = m_Colliders[i];
+			const Float32 bottom = std::min(m_Bounds.bottom[i], m_Bounds.top[i]);
+			const Float32 top = std::max(m_Bounds.bottom[i], m_Bounds.top[i]);
+			m_Index.Add(collider.entity, collider.layer, {collider.minX, bottom}, {collider.maxX, top});
+		}
+		m_Index.Build();
+		m_IndexDirty = false;
+	}
+
+	return m_Index;
+}
+
+Bool SimpleCollisionsSystem::Interacts(const Collider& first_, const Collider& second_) const
+{
+	return !(first_.isStatic && second_.isStatic) && (first_.layer & second_.mask) != 0 &&
+		   (second_.layer & first_.mask) != 0;
+}
+
+Bool SimpleCollisionsSystem::Overlaps(UInt32 first_, UInt32 second_) const
+{
+	return m_Bounds.left[first_] < m_Bounds.right[second_] && m_Bounds.right[first_] > m_Bounds.left[second_] &&
+		   m_Bounds.bottom[first_] < m_Bounds.top[second_] && m_Bounds.top[first_] > m_Bounds.bottom[second_];
+}
+
+void SimpleCollisionsSystem::AddContact(UInt32 first_, UInt32 second_)
+{
+	auto& a = m_Colliders[first_];
+	auto& b = m_Colliders[second_];
+
+	// processing one collision per frame for each colider
+	a.collision->colided = true;
+	a.collision->colidedWith = b.entity;
+
+	b.collision->colided = true;
+	b.collision->colidedWith = a.entity;
+
+	// ordered by id so the same pair matches up from frame to frame
+	const Bool swapped = entt::to_integral(b.entity) < entt::to_integral(a.entity);
+	const UInt32 first = swapped ? second_ : first_;
+	const UInt32 second = swapped ? first_ : second_;
+
+	const auto& p1 = m_Colliders[first].transform->position;
+	const auto& p2 = m_Colliders[second].transform->position;
+	const auto& c1 = *m_Colliders[first].collision;
+	const auto& c2 = *m_Colliders[second].collision;
+
+	Contact contact;
+	contact.a = m_Colliders[first].entity;
+	contact.b = m_Colliders[second].entity;
+	contact.sides = c1.GetCollisionSides(p1, c2, p2);
+	contact.center = c1.GetCollisionCenter(p1, c2, p2);
+	contact.penetration =
+		contact.sides.x != 0
+			? std::min(m_Colliders[first].maxX, m_Colliders[second].maxX) -
+				  std::max(m_Colliders[first].minX, m_Colliders[second].minX)
+			: std::min(m_Bounds.top[first], m_Bounds.top[second]) -
+				  std::max(m_Bounds.bottom[first], m_Bounds.bottom[second]);
+
+	m_Contacts.push_back(contact);
+}
+
+void SimpleCollisionsSystem::RunAllPairs()
+{
+	const UInt32 count = m_Colliders.size();
+
+	// the reference every broadphase is checked against: no pair is stored, and pairs that can't interact are
+	// dropped before any geometry is looked at
+	for (UInt32 i = 0; i < count; i++)
+	{
+		for (UInt32 j = i + 1; j < count; j++)
+		{
+			if (Interacts(m_Colliders[i], m_Colliders[j]) && Overlaps(i, j))
+				AddContact(i, j);
+		}
+	}
+}
+
+void SimpleCollisionsSystem::RunSweepAndPrune()
+{
+	const UInt32 count = m_Colliders.size();
+
+	m_SortedByX.resize(count);
+	std::iota(m_SortedByX.begin(), m_SortedByX.end(), 0);
+	std::sort(
+		m_SortedByX.begin(), m_SortedByX.end(),
+		[this](UInt32 a_, UInt32 b_) { return m_Colliders[a_].minX < m_Colliders[b_].minX; });
+
+	// everything starting before this collider ends overlaps it on x
+	m_Candidates.clear();
+	for (UInt32 i = 0; i < count; i++)
+	{
+		const auto& current = m_Colliders[m_SortedByX[i]];
+		for (UInt32 j = i + 1; j < count && m_Colliders[m_SortedByX[j]].minX < current.maxX; j++)
+		{
+			if (!Interacts(current, m_Colliders[m_SortedByX[j]]))
+				continue;
+
+			const UInt32 a = m_SortedByX[i];
+			const UInt32 b = m_SortedByX[j];
+			m_Candidates.emplace_back(std::min(a, b), std::max(a, b));
+		}
+	}
+
+	TestCandidates();
+}
+
+void SimpleCollisionsSystem::UpdateTree()
+{
+	m_TreeStamp++;
+
+	// leaves are fattened, so colliders that stayed put or barely moved leave the tree as it is
+	for (UInt32 i = 0; i < m_Colliders.size(); i++)
 	{
-		auto& collision = view.get<SimpleCollision>(*it);
-		auto& transform = view.get<Transform>(*it);
+		const auto& collider = m_Colliders[i];
+		const Vector2 min {collider.minX, std::min(m_Bounds.bottom[i], m_Bounds.top[i])};
+		const Vector2 max {collider.maxX, std::max(m_Bounds.bottom[i], m_Bounds.top[i])};
+
+		auto found = m_Proxies.find(collider.entity);
+		if (found == m_Proxies.end())
+		{
+			m_Proxies.emplace(collider.entity, TreeProxy {m_Tree.Insert(min, max, i), min, m_TreeStamp});
+			continue;
+		}
 
-		auto it2 = it;
-		it2++;
-		while (it2 != view.end())
+		auto& proxy = found.value();
+		m_Tree.Move(proxy.node, min, max, min - proxy.lastMin);
+		m_Tree.SetData(proxy.node, i);
+		proxy.lastMin = min;
+		proxy.stamp = m_TreeStamp;
+	}
+
+	// colliders that were destroyed or detached since last frame
+	for (auto it = m_Proxies.begin(); it != m_Proxies.end();)
+	{
+		if (it->second.stamp == m_TreeStamp)
 		{
-			auto& col = view.get<SimpleCollision>(*it2);
-			auto& tr = view.get<Transform>(*it2);
+			++it;
+			continue;
+		}
+
+		m_Tree.Remove(it->second.node);
+		it = m_Proxies.erase(it);
+	}
+}
+
+void SimpleCollisionsSystem::RunTree()
+{
+	UpdateTree();
+
+	// static colliders never look for partners themselves, the dynamic ones touching them find them
+	m_Candidates.clear();
+	for (UInt32 i = 0; i < m_Colliders.size(); i++)
+	{
+		const auto& collider = m_Colliders[i];
+		if (collider.isStatic)
+			continue;
 
-			// processing one collision per frame for each colider
-			if (collision.IsCollided(transform.position, col, tr.position))
+		const Vector2 min {collider.minX, std::min(m_Bounds.bottom[i], m_Bounds.top[i])};
+		const Vector2 max {collider.maxX, std::max(m_Bounds.bottom[i], m_Bounds.top[i])};
+		m_Tree.Query(
+			min, max,
+			[&](SInt32 node_)
 			{
-				collision.colided = true;
-				collision.colidedWith = *it2;
+				const UInt32 j = m_Tree.Data(node_);
+
+				// two dynamic colliders find each other, the pair is kept from the lower index only
+				if (j == i || (j < i && !m_Colliders[j].isStatic) || !Interacts(collider, m_Colliders[j]))
+					return;
+
+				m_Candidates.emplace_back(std::min(i, j), std::max(i, j));
+			});
+	}
+
+	TestCandidates();
+}
+
+void SimpleCollisionsSystem::TestCandidates()
+{
+	// later pairs overwrite colidedWith, so they are resolved in the order the all-pairs loop visits them
+	std::sort(m_Candidates.begin(), m_Candidates.end());
 
-				col.colided = true;
-				col.colidedWith = *it;
-			}
-			it2++;
+	// candidates are scattered, so each batch of four is gathered into place before testing
+	const UInt32 candidates = m_Candidates.size();
+	m_Hits.resize(candidates);
+
+	StaticArray<StaticArray<Float32, 4>, 8> gathered;
+	UInt32 c = 0;
+	for (; c + 4 <= candidates; c += 4)
+	{
+		for (UInt32 k = 0; k < 4; k++)
+		{
+			const auto [first, second] = m_Candidates[c + k];
+			gathered[0][k] = m_Bounds.left[first];
+			gathered[1][k] = m_Bounds.right[first];
+			gathered[2][k] = m_Bounds.bottom[first];
+			gathered[3][k] = m_Bounds.top[first];
+			gathered[4][k] = m_Bounds.left[second];
+			gathered[5][k] = m_Bounds.right[second];
+			gathered[6][k] = m_Bounds.bottom[second];
+			gathered[7][k] = m_Bounds.top[second];
 		}
-		it++;
+
+		const Edges4 firsts {gathered[0].data(), gathered[1].data(), gathered[2].data(), gathered[3].data()};
+		const Edges4 seconds {gathered[4].data(), gathered[5].data(), gathered[6].data(), gathered[7].data()};
+		Overlap4(firsts, seconds, &m_Hits[c]);
 	}
+	for (; c < candidates; c++)
+	{
+		m_Hits[c] = Overlaps(m_Candidates[c].first, m_Candidates[c].second);
+	}
+
+	for (c = 0; c < candidates; c++)
+	{
+		if (m_Hits[c])
+			AddContact(m_Candidates[c].first, m_Candidates[c].second);
+	}
+}
+
+void SimpleCollisionsSystem::DispatchContactEvents()
+{
+	static auto byPair = [](const Contact& x_, const Contact& y_)
+	{
+		const auto xa = entt::to_integral(x_.a);
+		const auto ya = entt::to_integral(y_.a);
+		return xa != ya ? xa < ya : entt::to_integral(x_.b) < entt::to_integral(y_.b);
+	};
+
+	std::sort(m_Contacts.begin(), m_Contacts.end(), byPair);
+
+	m_Began.clear();
+	m_Stayed.clear();
+	m_Ended.clear();
+
+	// both lists are sorted, one merge pass tells new, kept and lost pairs apart
+	auto current = m_Contacts.begin();
+	auto previous = m_PreviousContacts.begin();
+	while (current != m_Contacts.end() || previous != m_PreviousContacts.end())
+	{
+		if (previous == m_PreviousContacts.end() || (current != m_Contacts.end() && byPair(*current, *previous)))
+		{
+			m_Began.push_back(*current++);
+		}
+		else if (current == m_Contacts.end() || byPair(*previous, *current))
+		{
+			m_Ended.push_back(*previous++);
+		}
+		else
+		{
+			m_Stayed.push_back(*current++);
+			previous++;
+		}
+	}
+
+	if (!m_Began.empty())
+		Engine::Dispatcher().trigger<ContactsBegan>(ContactsBegan {&m_Began});
+
+	if (!m_Stayed.empty())
+		Engine::Dispatcher().trigger<ContactsStayed>(ContactsStayed {&m_Stayed});
+
+	if (!m_Ended.empty())
+		Engine::Dispatcher().trigger<ContactsEnded>(ContactsEnded {&m_Ended});
+}
+
+SweepHit SimpleCollisionsSystem::Sweep(Entity entity_, Vector2 displacement_)
+{
+	SweepHit hit;
+
+	const auto found = m_ColliderIndex.find(entity_);
+	if (found == m_ColliderIndex.end())
+		return hit;
+
+	const UInt32 mover = found->second;
+	const Vector2 min {m_Bounds.left[mover], m_Bounds.bottom[mover]};
+	const Vector2 max {m_Bounds.right[mover], m_Bounds.top[mover]};
+
+	// only colliders the swept box reaches are worth a full test
+	const Vector2 boxMin = glm::min(min, max) + glm::min(displacement_, Vector2 {0, 0});
+	const Vector2 boxMax = glm::max(min, max) + glm::max(displacement_, Vector2 {0, 0});
+	const QueryFilter filter {m_Colliders[mover].mask, entity_};
+
+	for (auto entity : Index().OverlapBox(boxMin, boxMax, filter))
+	{
+		const UInt32 other = m_ColliderIndex[entity];
+		if (!Interacts(m_Colliders[mover], m_Colliders[other]))
+			continue;
+
+		Float32 time;
+		Vector2 normal;
+		if (TimeOfImpact(
+				min, max, displacement_, {m_Bounds.left[other], m_Bounds.bottom[other]},
+				{m_Bounds.right[other], m_Bounds.top[other]}, time, normal) &&
+			time < hit.time)
+		{
+			hit.entity = entity;
+			hit.time = time;
+			hit.normal = normal;
+		}
+	}
+
+	return hit;
 }
 
 // SimpleCollision
@@ -84,3 +527,13 @@ SimpleCollision::GetCollisionCenter(const Vector3& pos_, const SimpleCollision&
 
 	return res;
 }
+
+Bool SimpleCollision::GetTimeOfImpact(
+	const Vector3& pos_, Vector2 displacement_, const SimpleCollision& other_, const Vector3& posOther_,
+	Float32& time_, Vector2& normal_) const
+{
+	Vector2 p(pos_.x + pivot.x * size.x, pos_.y + pivot.y * size.y);
+	Vector2 p2(posOther_.x + other_.pivot.x * other_.size.x, posOther_.y + other_.pivot.y * other_.size.y);
+
+	return TimeOfImpact(p, p + size, displacement_, p2, p2 + other_.size, time_, normal_);
+}
@@ -1,9 +1,21 @@
 #pragma once
 #include "core/core.h"
+#include "core/game/transforms.h"
 #include "core/system.h"
+#include "gameplay/common/aabb_tree.h"
+#include "gameplay/common/spatial_query.h"
 
 using namespace dagger;
 
+// SweepHit: where a moving collider first touches another one, as a fraction of the displacement it was swept by.
+// `normal` is the face that was hit, pointing back towards the mover.
+struct SweepHit
+{
+	Entity entity {entt::null};
+	Float32 time {1.0f};
+	Vector2 normal {0, 0};
+};
+
 struct SimpleCollision
 {
 	Vector2 size;
@@ -12,21 +24,161 @@ struct SimpleCollision
 	bool colided = false;
 	entt::entity colidedWith;
 
+	// the layers this collider is on and the layers it collides with; a pair is tested only if each side's
+	// mask has a bit of the other side's layer. Spatial queries filter on the layer too, see QueryFilter
+	UInt32 layer {1};
+	UInt32 mask {~0u};
+
+	// never moves on its own; two static colliders are never tested against each other
+	Bool isStatic {false};
+
+	// fast movers: the owner sweeps each step with SimpleCollisionsSystem::Sweep instead of moving blindly
+	Bool ccd {false};
+
 	bool IsCollided(const Vector3& pos_, const SimpleCollision& other_, const Vector3& posOther_) const;
 
 	// return (0,1) if collision happen by y, (1,0) if collision happen by x
 	Vector2 GetCollisionSides(const Vector3& pos_, const SimpleCollision& other_, const Vector3& posOther_) const;
 
 	Vector3 GetCollisionCenter(const Vector3& pos_, const SimpleCollision& other_, const Vector3& posOther_) const;
+
+	// swept AABB test: true if moving by displacement_ makes this touch other_ within the step.
+	// Pairs that already overlap are left to the discrete test and never report a hit here.
+	Bool GetTimeOfImpact(
+		const Vector3& pos_, Vector2 displacement_, const SimpleCollision& other_, const Vector3& posOther_,
+		Float32& time_, Vector2& normal_) const;
+};
+
+// Contact: a pair of overlapping colliders, with `a` the lower entity id.
+// Sides, penetration and center are computed once, from a's point of view (see GetCollisionSides).
+struct Contact
+{
+	Entity a;
+	Entity b;
+	Vector2 sides;
+	Float32 penetration;
+	Vector3 center;
 };
 
-class SimpleCollisionsSystem : public System
+// ContactsBegan, ContactsStayed, ContactsEnded: fired by SimpleCollisionsSystem at most once per frame each,
+// with every pair that started touching, kept touching or stopped touching. Ended contacts keep last frame's data,
+// and their entities may already be destroyed.
+struct ContactsBegan
 {
+	ViewPtr<const Sequence<Contact>> contacts;
+};
+
+struct ContactsStayed
+{
+	ViewPtr<const Sequence<Contact>> contacts;
+};
+
+struct ContactsEnded
+{
+	ViewPtr<const Sequence<Contact>> contacts;
+};
+
+// ECollisionBroadphase: how SimpleCollisionsSystem picks the pairs worth an overlap test.
+// Set with [collisions] broadphase: false for all pairs, true or sweep for sort-and-sweep, tree for the AABB tree.
+enum class ECollisionBroadphase
+{
+	AllPairs,
+	SweepAndPrune,
+	Tree
+};
+
+// SimpleCollisionsSystem: finds every overlapping pair of colliders, lists them in Contacts() and marks
+// the colliders themselves, where colidedWith keeps whichever pair was tested last.
+// Pairs that don't interact (see SimpleCollision::mask and isStatic) are dropped before any overlap test.
+// A broadphase picks the candidate pairs, which are then tested in the same order the all-pairs loop would,
+// so every broadphase gives the same results. Sort-and-sweep rebuilds from scratch each frame; the AABB tree
+// keeps colliders between frames and only queries from dynamic ones, which suits large mostly static levels.
+class SimpleCollisionsSystem
+	: public System
+	, public Publisher<ContactsBegan, ContactsStayed, ContactsEnded>
+{
+	struct Collider
+	{
+		Entity entity;
+		// point into the registry's pools, so they are only used while Run holds them
+		SimpleCollision* collision;
+		Transform* transform;
+		Float32 minX;
+		Float32 maxX;
+		UInt32 layer;
+		UInt32 mask;
+		Bool isStatic;
+	};
+
+	// world-space edges of m_Colliders, one array per edge so pairs can be tested several at a time
+	struct ColliderBounds
+	{
+		Sequence<Float32> left;
+		Sequence<Float32> right;
+		Sequence<Float32> bottom;
+		Sequence<Float32> top;
+	};
+
+	// a collider's leaf in m_Tree, with its box as of the last update
+	struct TreeProxy
+	{
+		SInt32 node;
+		Vector2 lastMin;
+		UInt32 stamp;
+	};
+
+	Sequence<Collider> m_Colliders;
+	Map<Entity, UInt32> m_ColliderIndex;
+	ColliderBounds m_Bounds;
+	Sequence<UInt8> m_Hits;
+	Sequence<UInt32> m_SortedByX;
+	Sequence<Pair<UInt32, UInt32>> m_Candidates;
+
+	AABBTree m_Tree;
+	Map<Entity, TreeProxy> m_Proxies;
+	UInt32 m_TreeStamp {0};
+
+	SpatialIndex m_Index;
+	Bool m_IndexDirty {true};
+
+	Sequence<Contact> m_Contacts;
+	Sequence<Contact> m_PreviousContacts;
+	Sequence<Contact> m_Began;
+	Sequence<Contact> m_Stayed;
+	Sequence<Contact> m_Ended;
+
+	void GatherColliders();
+	void RunAllPairs();
+	void RunSweepAndPrune();
+	void RunTree();
+	void UpdateTree();
+	void TestCandidates();
+	Bool Interacts(const Collider& first_, const Collider& second_) const;
+	Bool Overlaps(UInt32 first_, UInt32 second_) const;
+	void AddContact(UInt32 first_, UInt32 second_);
+	void DispatchContactEvents();
+
 public:
+	ECollisionBroadphase broadphase {ECollisionBroadphase::SweepAndPrune};
+
 	inline String SystemName() const override
 	{
 		return "Simple Collisions System";
 	}
 
+	// first collider entity_ would touch when moved by displacement_. Everything, entity_ included, is where it
+	// was during this frame's collision pass; colliders moved, added or removed since then are not seen
+	SweepHit Sweep(Entity entity_, Vector2 displacement_);
+
+	// this frame's colliders for spatial queries, built on first use; see SpatialQuery::Colliders
+	const SpatialIndex& Index();
+
+	// every contact found this frame, ordered by entity ids
+	inline const Sequence<Contact>& Contacts() const
+	{
+		return m_Contacts;
+	}
+
+	void SpinUp() override;
 	void Run() override;
 };
@@ -0,0 +1,281 @@
+#include "spatial_query.h"
+
+#include "core/engine.h"
+#include "core/graphics/sprite.h"
+#include "gameplay/common/simple_collisions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace dagger;
+
+void SpatialIndex::Clear()
+{
+	m_Entities.clear();
+	m_Layers.clear();
+	m_Left.clear();
+	m_Right.clear();
+	m_Bottom.clear();
+	m_Top.clear();
+	m_SortedCount = 0;
+	m_MaxWidth = 0.0f;
+	m_Min = {0, 0};
+	m_Max = {0, 0};
+}
+
+void SpatialIndex::Add(Entity entity_, UInt32 layer_, Vector2 min_, Vector2 max_)
+{
+	m_Entities.push_back(entity_);
+	m_Layers.push_back(layer_);
+	m_Left.push_back(min_.x);
+	m_Right.push_back(max_.x);
+	m_Bottom.push_back(min_.y);
+	m_Top.push_back(max_.y);
+}
+
+void SpatialIndex::Build()
+{
+	const UInt32 count = m_Entities.size();
+
+	// anything over four times the median width is left out of the sorted range
+	Sequence<Float32> widths(count);
+	m_Min = Vector2 {std::numeric_limits<Float32>::max()};
+	m_Max = Vector2 {std::numeric_limits<Float32>::lowest()};
+	for (UInt32 i = 0; i < count; i++)
+	{
+		widths[i] = m_Right[i] - m_Left[i];
+		m_Min = glm::min(m_Min, Vector2 {m_Left[i], m_Bottom[i]});
+		m_Max = glm::max(m_Max, Vector2 {m_Right[i], m_Top[i]});
+	}
+	Float32 wide = 0.0f;
+	if (count > 0)
+	{
+		std::nth_element(widths.begin(), widths.begin() + count / 2, widths.end());
+		wide = std::max(widths[count / 2] * 4.0f, 1.0f);
+	}
+
+	Sequence<UInt32> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	const auto sortedEnd = std::partition(
+		order.begin(), order.end(), [this, wide](UInt32 index_) { return m_Right[index_] - m_Left[index_] <= wide; });
+	std::sort(order.begin(), sortedEnd, [this](UInt32 a_, UInt32 b_) { return m_Left[a_] < m_Left[b_]; });
+
+	m_SortedCount = sortedEnd - order.begin();
+	m_MaxWidth = 0.0f;
+	for (auto it = order.begin(); it != sortedEnd; ++it)
+	{
+		m_MaxWidth = std::max(m_MaxWidth, m_Right[*it] - m_Left[*it]);
+	}
+
+	auto permute = [&order, count](auto& values_)
+	{
+		std::remove_reference_t<decltype(values_)> sorted(count);
+		for (UInt32 i = 0; i < count; i++)
+		{
+			sorted[i] = values_[order[i]];
+		}
+		values_.swap(sorted);
+	};
+
+	permute(m_Entities);
+	permute(m_Layers);
+	permute(m_Left);
+	permute(m_Right);
+	permute(m_Bottom);
+	permute(m_Top);
+}
+
+Bool SpatialIndex::Accepts(UInt32 index_, const QueryFilter& filter_) const
+{
+	return (m_Layers[index_] & filter_.layers) != 0 && m_Entities[index_] != filter_.ignore;
+}
+
+template<typename Visit>
+void SpatialIndex::VisitBox(Vector2 min_, Vector2 max_, const QueryFilter& filter_, Visit&& visit_) const
+{
+	// nothing wider than m_MaxWidth can start further left than this and still reach min_.x
+	const auto sortedEnd = m_Left.begin() + m_SortedCount;
+	const auto first = std::lower_bound(m_Left.begin(), sortedEnd, min_.x - m_MaxWidth);
+	const auto last = std::upper_bound(first, sortedEnd, max_.x);
+
+	for (UInt32 i = first - m_Left.begin(), end = last - m_Left.begin(); i < end; i++)
+	{
+		if (m_Right[i] >= min_.x && m_Bottom[i] <= max_.y && m_Top[i] >= min_.y && Accepts(i, filter_))
+			visit_(i);
+	}
+
+	for (UInt32 i = m_SortedCount; i < m_Entities.size(); i++)
+	{
+		if (m_Left[i] <= max_.x && m_Right[i] >= min_.x && m_Bottom[i] <= max_.y && m_Top[i] >= min_.y &&
+			Accepts(i, filter_))
+			visit_(i);
+	}
+}
+
+Sequence<Entity> SpatialIndex::OverlapPoint(Vector2 point_, const QueryFilter& filter_) const
+{
+	return OverlapBox(point_, point_, filter_);
+}
+
+Sequence<Entity> SpatialIndex::OverlapBox(Vector2 min_, Vector2 max_, const QueryFilter& filter_) const
+{
+	Sequence<Entity> result;
+	VisitBox(min_, max_, filter_, [&](UInt32 index_) { result.push_back(m_Entities[index_]); });
+	return result;
+}
+
+Sequence<RayHit> SpatialIndex::Raycast(
+	Vector2 origin_, Vector2 direction_, Float32 maxDistance_, const QueryFilter& filter_) const
+{
+	Sequence<RayHit> result;
+
+	const Float32 length = glm::length(direction_);
+	if (EPSILON_ZERO(length))
+		return result;
+
+	const Vector2 direction = direction_ / length;
+
+	// an axis the ray doesn't move along stays put, even with an infinite distance
+	Vector2 end = origin_;
+	for (SInt32 axis = 0; axis < 2; axis++)
+	{
+		if (direction[axis] != 0)
+			end[axis] += direction[axis] * maxDistance_;
+	}
+
+	VisitBox(
+		glm::min(origin_, end), glm::max(origin_, end), filter_,
+		[&](UInt32 index_)
+		{
+			const Vector2 min {m_Left[index_], m_Bottom[index_]};
+			const Vector2 max {m_Right[index_], m_Top[index_]};
+
+			Float32 entry = 0.0f;
+			Float32 exit = maxDistance_;
+			Vector2 normal {0, 0};
+
+			// slab test; a ray starting inside a box hits it at distance 0
+			for (SInt32 axis = 0; axis < 2; axis++)
+			{
+				if (direction[axis] == 0)
+				{
+					if (origin_[axis] < min[axis] || origin_[axis] > max[axis])
+						return;
+					continue;
+				}
+
+				Float32 slabEntry = (min[axis] - origin_[axis]) / direction[axis];
+				Float32 slabExit = (max[axis] - origin_[axis]) / direction[axis];
+				if (slabEntry > slabExit)
+					std::swap(slabEntry, slabExit);
+
+				if (slabEntry > entry)
+				{
+					entry = slabEntry;
+					normal = {0, 0};
+					normal[axis] = direction[axis] > 0 ? -1.0f : 1.0f;
+				}
+				exit = std::min(exit, slabExit);
+
+				if (entry > exit)
+					return;
+			}
+
+			result.push_back(RayHit {m_Entities[index_], entry, origin_ + direction * entry, normal});
+		});
+
+	std::sort(
+		result.begin(), result.end(), [](const RayHit& a_, const RayHit& b_) { return a_.distance < b_.distance; });
+	return result;
+}
+
+Sequence<Entity> SpatialIndex::Nearest(Vector2 point_, UInt32 count_, const QueryFilter& filter_) const
+{
+	if (count_ == 0 || m_Entities.empty())
+		return {};
+
+	// the whole index fits in this radius, so the search always ends
+	const Vector2 reach = glm::max(glm::abs(m_Min - point_), glm::abs(m_Max - point_));
+	const Float32 limit = std::max(reach.x, reach.y);
+
+	// grow a box around the point until it holds count_ entries that are no further away than its half size;
+	// anything outside the box is further than that, so those are the nearest ones
+	Float32 radius = std::max(m_MaxWidth, 1.0f);
+	Sequence<Pair<Float32, Entity>> found;
+	while (true)
+	{
+		found.clear();
+		VisitBox(
+			point_ - radius, point_ + radius, filter_,
+			[&](UInt32 index_)
+			{
+				const Vector2 closest = glm::clamp(
+					point_, Vector2 {m_Left[index_], m_Bottom[index_]}, Vector2 {m_Right[index_], m_Top[index_]});
+				found.emplace_back(glm::length(closest - point_), m_Entities[index_]);
+			});
+
+		const UInt32 within = std::count_if(
+			found.begin(), found.end(), [radius](const auto& entry_) { return entry_.first <= radius; });
+		if (within >= count_ || radius >= limit)
+			break;
+
+		radius *= 2.0f;
+	}
+
+	const UInt32 count = std::min<UInt32>(count_, found.size());
+	std::partial_sort(
+		found.begin(), found.begin() + count, found.end(),
+		[](const auto& a_, const auto& b_) { return a_.first < b_.first; });
+
+	Sequence<Entity> result;
+	for (UInt32 i = 0; i < count; i++)
+	{
+		result.push_back(found[i].second);
+	}
+	return result;
+}
+
+// SpatialQuery
+
+const SpatialIndex& SpatialQuery::Colliders()
+{
+	static SpatialIndex s_Empty;
+
+	auto* collisions = Engine::GetDefaultResource<SimpleCollisionsSystem>();
+	return collisions != nullptr ? collisions->Index() : s_Empty;
+}
+
+const SpatialIndex& SpatialQuery::Sprites()
+{
+	static SpatialIndex s_Sprites;
+	static UInt64 s_BuiltOnFrame {~0ull};
+
+	if (s_BuiltOnFrame == Engine::FrameCount())
+		return s_Sprites;
+
+	s_BuiltOnFrame = Engine::FrameCount();
+	s_Sprites.Clear();
+
+	Engine::Registry().view<Sprite>().each(
+		[](Entity entity_, const Sprite& sprite_)
+		{
+			// the quad spans -0.5..0.5 around the pivot, scaled, then rotated around the sprite position
+			const Vector2 scale = sprite_.size * sprite_.scale;
+			const Vector2 center = sprite_.pivot * scale;
+			const Float32 radians = glm::radians(sprite_.rotation);
+			const Float32 cosine = std::abs(std::cos(radians));
+			const Float32 sine = std::abs(std::sin(radians));
+
+			const Vector2 halfExtent = glm::abs(scale) * 0.5f + glm::abs(center);
+			const Vector2 rotated {
+				cosine * halfExtent.x + sine * halfExtent.y, sine * halfExtent.x + cosine * halfExtent.y};
+
+			const Vector2 position {sprite_.position.x, sprite_.position.y};
+			s_Sprites.Add(entity_, 1, position - rotated, position + rotated);
+		});
+
+	s_Sprites.Build();
+	return s_Sprites;
+}
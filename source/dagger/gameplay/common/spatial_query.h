@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/core.h"
+
+using namespace dagger;
+
+// QueryFilter: which entries a spatial query looks at. Layers are bits matched against each entry's layer.
+struct QueryFilter
+{
+	UInt32 layers {~0u};
+	Entity ignore {entt::null};
+};
+
+// RayHit: where a ray enters an entry's box; `distance` is measured along the normalized direction.
+struct RayHit
+{
+	Entity entity;
+	Float32 distance;
+	Vector2 point;
+	Vector2 normal;
+};
+
+// SpatialIndex: axis-aligned boxes kept sorted by their left edge.
+// Queries binary search into the x range they can reach, instead of visiting every entry. Boxes much wider than
+// the typical one (walls, floors) would stretch that range for every query, so they are kept apart and checked
+// one by one.
+class SpatialIndex
+{
+	Sequence<Entity> m_Entities;
+	Sequence<UInt32> m_Layers;
+	Sequence<Float32> m_Left;
+	Sequence<Float32> m_Right;
+	Sequence<Float32> m_Bottom;
+	Sequence<Float32> m_Top;
+
+	// entries before this are sorted by m_Left, the wide ones after it are not
+	UInt32 m_SortedCount {0};
+	// widest of the sorted entries
+	Float32 m_MaxWidth {0.0f};
+	// bounds of every entry
+	Vector2 m_Min {0, 0};
+	Vector2 m_Max {0, 0};
+
+	Bool Accepts(UInt32 index_, const QueryFilter& filter_) const;
+
+	template<typename Visit>
+	void VisitBox(Vector2 min_, Vector2 max_, const QueryFilter& filter_, Visit&& visit_) const;
+
+public:
+	void Clear();
+	void Add(Entity entity_, UInt32 layer_, Vector2 min_, Vector2 max_);
+	// sorts what was added; queries are only valid after this
+	void Build();
+
+	inline UInt32 Size() const
+	{
+		return m_Entities.size();
+	}
+
+	Sequence<Entity> OverlapPoint(Vector2 point_, const QueryFilter& filter_ = {}) const;
+	Sequence<Entity> OverlapBox(Vector2 min_, Vector2 max_, const QueryFilter& filter_ = {}) const;
+
+	// every box the segment from origin_ along direction_ enters within maxDistance_, nearest first
+	Sequence<RayHit> Raycast(
+		Vector2 origin_, Vector2 direction_, Float32 maxDistance_, const QueryFilter& filter_ = {}) const;
+
+	// up to count_ entries with the closest boxes to point_, nearest first
+	Sequence<Entity> Nearest(Vector2 point_, UInt32 count_, const QueryFilter& filter_ = {}) const;
+};
+
+// SpatialQuery: shared indices over the world, built on the first query of a frame and reused for the rest of it.
+struct SpatialQuery
+{
+	// SimpleCollision boxes as of the last collision pass, filtered by SimpleCollision::layer
+	static const SpatialIndex& Colliders();
+
+	// bounds of all sprites, visible or not, rotation included; every sprite is on layer 1
+	static const SpatialIndex& Sprites();
+};
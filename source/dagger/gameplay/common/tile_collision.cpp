@@ -0,0 +1,236 @@
+#include "tile_collision.h"
+
+#include "core/engine.h"
+#include "core/graphics/sprite.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace dagger;
+
+namespace
+{
+	// keeps edges that sit exactly on a cell border out of that cell
+	constexpr Float32 s_Skin = 0.001f;
+
+	Bool IsSlope(ETileShape shape_)
+	{
+		return shape_ == ETileShape::SlopeUp || shape_ == ETileShape::SlopeDown;
+	}
+} // namespace
+
+void TileGrid::Resize(UInt32 width_, UInt32 height_)
+{
+	width = width_;
+	height = height_;
+	tiles.assign(width * height, ETileShape::Empty);
+}
+
+void TileGrid::Set(SInt32 column_, SInt32 row_, ETileShape shape_)
+{
+	if (column_ < 0 || row_ < 0 || column_ >= (SInt32)width || row_ >= (SInt32)height)
+		return;
+
+	tiles[row_ * width + column_] = shape_;
+}
+
+void TileGrid::Fill(SInt32 column0_, SInt32 row0_, SInt32 column1_, SInt32 row1_, ETileShape shape_)
+{
+	for (SInt32 row = std::min(row0_, row1_); row <= std::max(row0_, row1_); row++)
+	{
+		for (SInt32 column = std::min(column0_, column1_); column <= std::max(column0_, column1_); column++)
+		{
+			Set(column, row, shape_);
+		}
+	}
+}
+
+ETileShape TileGrid::At(SInt32 column_, SInt32 row_) const
+{
+	if (column_ < 0 || row_ < 0 || column_ >= (SInt32)width || row_ >= (SInt32)height)
+		return ETileShape::Empty;
+
+	return tiles[row_ * width + column_];
+}
+
+Float32 TileGrid::SlopeSurface(SInt32 column_, SInt32 row_, Float32 x_) const
+{
+	const ETileShape shape = At(column_, row_);
+	if (!IsSlope(shape))
+		return std::numeric_limits<Float32>::lowest();
+
+	const Float32 along = std::clamp((x_ - origin.x) / tileSize - column_, 0.0f, 1.0f);
+	return origin.y + (row_ + (shape == ETileShape::SlopeUp ? along : 1.0f - along)) * tileSize;
+}
+
+TileMove TileGrid::Move(
+	Vector2 min_, Vector2 size_, Vector2 displacement_, Bool dropThrough_, Bool stickToGround_) const
+{
+	TileMove result;
+	result.min = min_;
+
+	// x: only solid cells stop the box. While standing on a slope the row of the feet is left out,
+	// otherwise the edge of the ground at the top of the slope would block the way up
+	if (displacement_.x != 0)
+	{
+		const SInt32 feetRow = RowAt(result.min.y + s_Skin);
+		const Bool onSlope = IsSlope(At(ColumnAt(result.min.x + size_.x * 0.5f), feetRow));
+		const SInt32 firstRow = onSlope ? feetRow + 1 : feetRow;
+		const SInt32 lastRow = RowAt(result.min.y + size_.y - s_Skin);
+
+		const auto isWall = [&](SInt32 column_)
+		{
+			for (SInt32 row = firstRow; row <= lastRow; row++)
+			{
+				if (At(column_, row) == ETileShape::Solid)
+					return true;
+			}
+			return false;
+		};
+
+		if (displacement_.x > 0)
+		{
+			const Float32 edge = result.min.x + size_.x;
+			Float32 reached = edge + displacement_.x;
+			for (SInt32 column = ColumnAt(edge - s_Skin) + 1, last = ColumnAt(reached - s_Skin); column <= last;
+				 column++)
+			{
+				if (isWall(column))
+				{
+					reached = origin.x + column * tileSize;
+					result.hitRight = true;
+					break;
+				}
+			}
+			result.min.x = reached - size_.x;
+		}
+		else
+		{
+			const Float32 edge = result.min.x;
+			Float32 reached = edge + displacement_.x;
+			for (SInt32 column = ColumnAt(edge + s_Skin) - 1, last = ColumnAt(reached + s_Skin); column >= last;
+				 column--)
+			{
+				if (isWall(column))
+				{
+					reached = origin.x + (column + 1) * tileSize;
+					result.hitLeft = true;
+					break;
+				}
+			}
+			result.min.x = reached;
+		}
+	}
+
+	const SInt32 firstColumn = ColumnAt(result.min.x + s_Skin);
+	const SInt32 lastColumn = ColumnAt(result.min.x + size_.x - s_Skin);
+
+	// y up: only solid cells, anything else can be jumped through from below
+	if (displacement_.y > 0)
+	{
+		const Float32 edge = result.min.y + size_.y;
+		Float32 reached = edge + displacement_.y;
+		for (SInt32 row = RowAt(edge - s_Skin) + 1, last = RowAt(reached - s_Skin); row <= last && !result.hitCeiling;
+			 row++)
+		{
+			for (SInt32 column = firstColumn; column <= lastColumn; column++)
+			{
+				if (At(column, row) == ETileShape::Solid)
+				{
+					reached = origin.y + row * tileSize;
+					result.hitCeiling = true;
+					break;
+				}
+			}
+		}
+		result.min.y = reached - size_.y;
+		return result;
+	}
+
+	// y down: the highest floor between the feet and where they would end up, looking a bit further
+	// when the box should stay on the ground. Moving sideways lifts the feet by as much as the box moved,
+	// which is what walking up a slope, and off its top onto the ground beside it, takes
+	const Float32 bottom = result.min.y;
+	const Float32 climb = bottom + std::abs(result.min.x - min_.x);
+	const Float32 target = bottom + displacement_.y;
+	const Float32 probe = target - (stickToGround_ ? tileSize * 0.5f : 0.0f);
+	Float32 ground = std::numeric_limits<Float32>::lowest();
+
+	for (SInt32 row = RowAt(climb + s_Skin) - 1, last = RowAt(probe); row >= last && ground < probe; row--)
+	{
+		for (SInt32 column = firstColumn; column <= lastColumn; column++)
+		{
+			const ETileShape shape = At(column, row);
+			if (shape == ETileShape::Solid || (shape == ETileShape::OneWay && !dropThrough_))
+			{
+				ground = origin.y + (row + 1) * tileSize;
+				break;
+			}
+		}
+	}
+
+	// slopes are stood on by the middle of the box
+	const Float32 centerX = result.min.x + size_.x * 0.5f;
+	const SInt32 centerColumn = ColumnAt(centerX);
+	for (SInt32 row = RowAt(climb), last = RowAt(probe); row >= last; row--)
+	{
+		const Float32 surface = SlopeSurface(centerColumn, row, centerX);
+		if (surface <= climb + s_Skin && surface > probe)
+		{
+			if (surface > ground)
+			{
+				ground = surface;
+				result.onSlope = true;
+			}
+			break;
+		}
+	}
+
+	if (ground > probe)
+	{
+		result.min.y = ground;
+		result.onGround = true;
+	}
+	else
+	{
+		result.min.y = target;
+	}
+
+	return result;
+}
+
+// TileCollisionSystem
+
+void TileCollisionSystem::Run()
+{
+	const auto* grid = Engine::GetDefaultResource<TileGrid>();
+	if (grid == nullptr)
+		return;
+
+	const Float32 deltaTime = Engine::DeltaTime();
+
+	Engine::Registry().view<TileBody, Sprite>().each(
+		[&](TileBody& body_, Sprite& sprite_)
+		{
+			body_.velocity.y -= body_.gravity * deltaTime;
+
+			const Vector2 min = (Vector2)sprite_.position + body_.offset - body_.size * 0.5f;
+			const TileMove move =
+				grid->Move(min, body_.size, body_.velocity * deltaTime, body_.dropThrough, body_.onGround);
+
+			sprite_.position.x += move.min.x - min.x;
+			sprite_.position.y += move.min.y - min.y;
+
+			body_.onGround = move.onGround;
+			body_.onSlope = move.onSlope;
+			body_.hitCeiling = move.hitCeiling;
+			body_.hitLeft = move.hitLeft;
+			body_.hitRight = move.hitRight;
+
+			// whatever stopped the box also stops its speed that way
+			if ((move.onGround && body_.velocity.y < 0) || (move.hitCeiling && body_.velocity.y > 0))
+				body_.velocity.y = 0;
+			if ((move.hitLeft && body_.velocity.x < 0) || (move.hitRight && body_.velocity.x > 0))
+				body_.velocity.x = 0;
+		});
+}
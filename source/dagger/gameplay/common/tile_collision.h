@@ -0,0 +1,99 @@
+#pragma once
+
+#include "core/core.h"
+#include "core/system.h"
+
+#include <cmath>
+
+using namespace dagger;
+
+enum class ETileShape : UInt8
+{
+	Empty,
+	Solid,
+	// only stops things falling onto it from above
+	OneWay,
+	// walkable diagonals: Up rises to the right, Down falls to the right
+	SlopeUp,
+	SlopeDown
+};
+
+// TileMove: where a box ended up after TileGrid::Move, and what it ran into on the way.
+struct TileMove
+{
+	Vector2 min {0, 0};
+	Bool onGround {false};
+	Bool onSlope {false};
+	Bool hitCeiling {false};
+	Bool hitLeft {false};
+	Bool hitRight {false};
+};
+
+// TileGrid: which cells of a tile map are occupied, row 0 at the bottom. Anything outside the grid is empty.
+// Moving a box only looks at the cells it sweeps over, so the size of the level doesn't matter.
+struct TileGrid
+{
+	// bottom left corner of cell (0, 0)
+	Vector2 origin {0, 0};
+	Float32 tileSize {16.0f};
+	UInt32 width {0};
+	UInt32 height {0};
+	Sequence<ETileShape> tiles;
+
+	void Resize(UInt32 width_, UInt32 height_);
+	void Set(SInt32 column_, SInt32 row_, ETileShape shape_);
+
+	// every cell from the first corner to the second, both included
+	void Fill(SInt32 column0_, SInt32 row0_, SInt32 column1_, SInt32 row1_, ETileShape shape_);
+
+	ETileShape At(SInt32 column_, SInt32 row_) const;
+
+	inline SInt32 ColumnAt(Float32 x_) const
+	{
+		return static_cast<SInt32>(std::floor((x_ - origin.x) / tileSize));
+	}
+
+	inline SInt32 RowAt(Float32 y_) const
+	{
+		return static_cast<SInt32>(std::floor((y_ - origin.y) / tileSize));
+	}
+
+	// moves the box at min_ by displacement_, x first, stopping at whatever blocks it.
+	// dropThrough_ falls through one-way cells; stickToGround_ keeps a box that was standing on
+	// the ground there when it walks down a slope or a small step.
+	TileMove Move(Vector2 min_, Vector2 size_, Vector2 displacement_, Bool dropThrough_, Bool stickToGround_) const;
+
+private:
+	// height of the slope in cell (column_, row_) at x_, or lowest() if the cell isn't a slope
+	Float32 SlopeSurface(SInt32 column_, SInt32 row_, Float32 x_) const;
+};
+
+// TileBody: a box that moves through the TileGrid default resource instead of passing through terrain.
+// The box is centered at the sprite position plus offset. Gameplay sets velocity; TileCollisionSystem
+// applies gravity, moves the sprite and fills in what the body touched.
+struct TileBody
+{
+	Vector2 size {16, 16};
+	Vector2 offset {0, 0};
+	Vector2 velocity {0, 0};
+	Float32 gravity {0.0f};
+	Bool dropThrough {false};
+
+	Bool onGround {false};
+	Bool onSlope {false};
+	Bool hitCeiling {false};
+	Bool hitLeft {false};
+	Bool hitRight {false};
+};
+
+// TileCollisionSystem: moves every TileBody through the TileGrid, if a level put one up.
+class TileCollisionSystem : public System
+{
+public:
+	inline String SystemName() const override
+	{
+		return "Tile Collision System";
+	}
+
+	void Run() override;
+};
@@ -14,6 +14,7 @@
 #include "core/input/inputs.h"
 #include "core/savegame.h"
 #include "gameplay/common/simple_collisions.h"
+#include "gameplay/common/spatial_query.h"
 #include "gameplay/editor/savegame_system.h"
 #include "tools/diagnostics.h"
 
@@ -208,38 +209,44 @@ void EditorToolSystem::UpdateTargets()
 	auto& knob = m_Registry.get<Sprite>(m_Focus);
 	m_Targets.clear();
 
-	const auto* cam = Engine::GetDefaultResource<Camera>();
+	auto& reg = Engine::Registry();
+	const Vector2 knobPosition {knob.position.x, knob.position.y};
 
-	Engine::Registry().view<Sprite, SaveGame<ECommonSaveArchetype>>().each(
-		[&](Entity entity_, const Sprite& sprite_, const SaveGame<ECommonSaveArchetype>& save_)
-		{
-			const auto left = sprite_.position.x - (sprite_.size.x / 2) * sprite_.scale.x * cam->zoom;
-			const auto top = sprite_.position.y - (sprite_.size.y / 2) * sprite_.scale.y * cam->zoom;
+	for (auto entity : SpatialQuery::Sprites().OverlapPoint(knobPosition))
+	{
+		if (!reg.all_of<SaveGame<ECommonSaveArchetype>>(entity))
+			continue;
+
+		const auto& sprite = reg.get<Sprite>(entity);
+
+		// the index only knows bounding boxes, so the rotated rectangle is checked here
+		const auto left = sprite.position.x - (sprite.size.x / 2) * sprite.scale.x;
+		const auto top = sprite.position.y - (sprite.size.y / 2) * sprite.scale.y;
 
-			const auto right = sprite_.position.x + (sprite_.size.x / 2) * sprite_.scale.x * cam->zoom;
-			const auto bottom = sprite_.position.y + (sprite_.size.y / 2) * sprite_.scale.y * cam->zoom;
+		const auto right = sprite.position.x + (sprite.size.x / 2) * sprite.scale.x;
+		const auto bottom = sprite.position.y + (sprite.size.y / 2) * sprite.scale.y;
 
-			// Rotate the knob position by negative sprite rotation angle around the sprite position
-			// Then check collision as usual
-			const Vector3 knobRelative = knob.position - sprite_.position;
-			const double sine = sin(-sprite_.rotation * M_PI / 180.0f);
-			const double cosine = cos(-sprite_.rotation * M_PI / 180.0f);
-			const auto knobX = sprite_.position.x + knobRelative.x * cosine - knobRelative.y * sine;
-			const auto knobY = sprite_.position.y + knobRelative.x * sine + knobRelative.y * cosine;
+		// Rotate the knob position by negative sprite rotation angle around the sprite position
+		// Then check collision as usual
+		const Vector3 knobRelative = knob.position - sprite.position;
+		const double sine = sin(-sprite.rotation * M_PI / 180.0f);
+		const double cosine = cos(-sprite.rotation * M_PI / 180.0f);
+		const auto knobX = sprite.position.x + knobRelative.x * cosine - knobRelative.y * sine;
+		const auto knobY = sprite.position.y + knobRelative.x * sine + knobRelative.y * cosine;
 
-			if (knobX >= left && knobY >= top && knobX <= right && knobY <= bottom)
+		if (knobX >= left && knobY >= top && knobX <= right && knobY <= bottom)
+		{
+			if (reg.all_of<Animator>(entity))
 			{
-				if (Engine::Registry().all_of<Animator>(entity_))
-				{
-					auto& animator = Engine::Registry().get<Animator>(entity_);
-					m_Targets.push_back(EditorFocusTarget {entity_, animator.currentAnimation});
-				}
-				else
-				{
-					m_Targets.push_back(EditorFocusTarget {entity_, sprite_.image->Name()});
-				}
+				auto& animator = reg.get<Animator>(entity);
+				m_Targets.push_back(EditorFocusTarget {entity, animator.currentAnimation});
+			}
+			else
+			{
+				m_Targets.push_back(EditorFocusTarget {entity, sprite.image->Name()});
 			}
-		});
+		}
+	}
 }
 
 void EditorToolSystem::GUIDrawCameraEditor()
@@ -548,6 +555,16 @@ void EditorToolSystem::GUIDrawPhysicsEditor()
 			compCol.size.y = size[1];
 		}
 
+		/* Filtering */ {
+			ImGui::Checkbox("Static", &compCol.isStatic);
+			ImGui::InputScalar(
+				"Collision Layer", ImGuiDataType_U32, &compCol.layer, nullptr, nullptr, "%08X",
+				ImGuiInputTextFlags_CharsHexadecimal);
+			ImGui::InputScalar(
+				"Collision Mask", ImGuiDataType_U32, &compCol.mask, nullptr, nullptr, "%08X",
+				ImGuiInputTextFlags_CharsHexadecimal);
+		}
+
 		ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.6f, 0.2f, 0.2f, 1.0f));
 		ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.9f, 0.1f, 0.1f, 1.0f));
 		ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(1.0f, 0.1f, 0.1f, 1.0f));
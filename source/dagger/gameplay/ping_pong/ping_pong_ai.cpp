@@ -2,6 +2,9 @@
 
 #include "core/engine.h"
 #include "gameplay/common/simple_collisions.h"
+#include "gameplay/common/spatial_query.h"
+
+#include <limits>
 
 using namespace dagger;
 using namespace ping_pong;
@@ -30,20 +33,30 @@ Bool PingPongAISystem::ShouldConsiderBall(
 
 void PingPongAISystem::Run()
 {
-	auto view = Engine::Registry().view<Transform, AI>();
-	auto ballView = Engine::Registry().view<PingPongBall, Transform, SimpleCollision>();
+	auto& reg = Engine::Registry();
+	auto view = reg.view<Transform, AI>();
+	const auto& colliders = SpatialQuery::Colliders();
+	constexpr Float32 limit = std::numeric_limits<Float32>::max();
 
 	for (auto entity : view)
 	{
 		auto& t = view.get<Transform>(entity);
 		auto& ai = view.get<AI>(entity);
 
+		// only balls between the player and the middle of the field are of interest
+		const Bool isLeft = ai.side == EPlayerSide::LEFT;
+		const Vector2 min {isLeft ? t.position.x + 10 : 0.0f, -limit};
+		const Vector2 max {isLeft ? 0.0f : t.position.x - 10, limit};
+
 		std::vector<std::pair<float, float>> balls;
 
-		for (auto ball : ballView)
+		for (auto ball : colliders.OverlapBox(min, max, QueryFilter {PingPongBall::s_Layer}))
 		{
-			auto& b = ballView.get<PingPongBall>(ball);
-			auto& bt = ballView.get<Transform>(ball);
+			if (!reg.all_of<PingPongBall, Transform>(ball))
+				continue;
+
+			auto& b = reg.get<PingPongBall>(ball);
+			auto& bt = reg.get<Transform>(ball);
 
 			if (ShouldConsiderBall(bt, b, t, ai))
 				balls.emplace_back(bt.position.x / -b.speed.x, bt.position.y + 0.01f * b.speed.y);
@@ -2,75 +2,86 @@
 
 #include "core/engine.h"
 
+#include <tuple>
+
 using namespace dagger;
 using namespace ping_pong;
 
-void PingPongBallSystem::ResolveCollision(
-	Transform& t_, SimpleCollision& col_, PingPongBall& ball_, const Transform& otherTransform_,
-	const SimpleCollision& otherCollision_)
+void PingPongBallSystem::ResolveCollision(Transform& t_, Vector2 collisionSides_, Float32 penetration_)
 {
-	Vector2 collisionSides = col_.GetCollisionSides(t_.position, otherCollision_, otherTransform_.position);
-	do
-	{
-		// Get back for 1 frame
-		Float32 dt = Engine::DeltaTime();
-		if (std::abs(collisionSides.x) > 0)
-		{
-			t_.position.x -= (ball_.speed.x * dt);
-		}
-
-		if (std::abs(collisionSides.y) > 0)
-		{
-			t_.position.y -= (ball_.speed.y * dt);
-		}
-
-	} while (col_.IsCollided(t_.position, otherCollision_, otherTransform_.position));
+	// back out along the axis of the hit, exactly as far as the ball went in
+	t_.position.x -= collisionSides_.x * penetration_;
+	t_.position.y -= collisionSides_.y * penetration_;
+}
 
-	if (std::abs(collisionSides.x) > 0)
+void PingPongBallSystem::Bounce(PingPongBall& ball_, Vector2 collisionSides_, Entity other_)
+{
+	if (std::abs(collisionSides_.x) > 0)
 	{
 		ball_.speed.x *= -1;
 	}
 
-	if (std::abs(collisionSides.y) > 0)
+	if (std::abs(collisionSides_.y) > 0)
 	{
 		ball_.speed.y *= -1;
 	}
+
+	if (Engine::Registry().all_of<PingPongWall>(other_))
+	{
+		PingPongWall& wall = Engine::Registry().get<PingPongWall>(other_);
+		ball_.reachedGoal = true;
+		ball_.playerOneScored = !wall.isLeft;
+	}
 }
 
 void PingPongBallSystem::Run()
 {
-	auto viewCollisions = Engine::Registry().view<Transform, SimpleCollision>();
 	auto view = Engine::Registry().view<PingPongBall, Transform, SimpleCollision>();
-	for (auto entity : view)
-	{
-		auto& t = view.get<Transform>(entity);
-		auto& ball = view.get<PingPongBall>(entity);
-		auto& col = view.get<SimpleCollision>(entity);
+	auto* collisions = Engine::GetDefaultResource<SimpleCollisionsSystem>();
 
-		if (ball.reachedGoal)
+	// a ball bounces off at most one thing per frame, and doesn't move in a frame it bounced
+	m_Bounced.clear();
+	for (const auto& contact : collisions->Contacts())
+	{
+		// sides are seen from `a`, so they flip for `b`
+		const auto sidesOfA = std::make_tuple(contact.a, contact.b, contact.sides);
+		const auto sidesOfB = std::make_tuple(contact.b, contact.a, -contact.sides);
+		for (const auto& [entity, other, sides] : {sidesOfA, sidesOfB})
 		{
-			continue;
+			if (!view.contains(entity) || m_Bounced.contains(entity))
+				continue;
+
+			auto& ball = view.get<PingPongBall>(entity);
+			if (ball.reachedGoal)
+				continue;
+
+			ResolveCollision(view.get<Transform>(entity), sides, contact.penetration);
+			Bounce(ball, sides, other);
+			m_Bounced.insert(entity);
 		}
+	}
 
-		if (col.colided && Engine::Registry().valid(col.colidedWith))
-		{
-			SimpleCollision& collision = viewCollisions.get<SimpleCollision>(col.colidedWith);
-			Transform& transform = viewCollisions.get<Transform>(col.colidedWith);
+	for (auto entity : view)
+	{
+		auto& ball = view.get<PingPongBall>(entity);
+		if (ball.reachedGoal || m_Bounced.contains(entity))
+			continue;
 
-			ResolveCollision(t, col, ball, transform, collision);
+		auto& t = view.get<Transform>(entity);
+		const Vector3 displacement = ball.speed * Engine::DeltaTime();
 
-			if (Engine::Registry().all_of<PingPongWall>(col.colidedWith))
+		// fast balls stop right where they touch something instead of ending up inside or behind it
+		if (view.get<SimpleCollision>(entity).ccd)
+		{
+			const auto hit = collisions->Sweep(entity, {displacement.x, displacement.y});
+			if (hit.entity != entt::null)
 			{
-				PingPongWall& wall = Engine::Registry().get<PingPongWall>(col.colidedWith);
-				ball.reachedGoal = true;
-				ball.playerOneScored = !wall.isLeft;
+				t.position += displacement * hit.time;
+				Bounce(ball, hit.normal, hit.entity);
+				continue;
 			}
-
-			col.colided = false;
-		}
-		else
-		{
-			t.position += (ball.speed * Engine::DeltaTime());
 		}
+
+		t.position += displacement;
 	}
 }
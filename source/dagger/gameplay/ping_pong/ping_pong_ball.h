@@ -11,6 +11,9 @@ namespace ping_pong
 {
 	struct PingPongBall
 	{
+		// collision layer of every ball, so spatial queries can look for balls only
+		constexpr static UInt32 s_Layer = 1u << 1;
+
 		Vector3 speed {0, 0, 0};
 
 		bool reachedGoal {false};
@@ -25,9 +28,10 @@ namespace ping_pong
 
 	class PingPongBallSystem : public System
 	{
-		void ResolveCollision(
-			Transform& t_, SimpleCollision& col_, PingPongBall& ball_, const Transform& otherTransform_,
-			const SimpleCollision& otherCollision_);
+		Set<Entity> m_Bounced;
+
+		void ResolveCollision(Transform& t_, Vector2 collisionSides_, Float32 penetration_);
+		void Bounce(PingPongBall& ball_, Vector2 collisionSides_, Entity other_);
 
 	public:
 		inline String SystemName() const override
@@ -26,18 +26,17 @@ using namespace ping_pong;
 
 void ping_pong::CreateRandomPingPongBall(float tileSize_, int fieldHeight_)
 {
-	// Done without if for better performance
+	auto& random = Random::Thread();
 	CreatePingPongBall(
 		tileSize_,
 		// Random color
-		ColorRGBA(rand() % 255 / 255.0f, rand() % 255 / 255.0f, rand() % 255 / 255.0f, 1),
+		ColorRGBA(random.Uniform(), random.Uniform(), random.Uniform(), 1),
 		// Random speed
 		// in range [4, 13] in each direction
-		// ((rand()%2+2)%3-1) is a -1 or 1 value
-		{(rand() % 10 + 4) * ((rand() % 2 + 2) % 3 - 1), (rand() % 10 + 4) * ((rand() % 2 + 2) % 3 - 1), 0},
+		{random.Range(4, 13) * random.Sign(), random.Range(4, 13) * random.Sign(), 0},
 		// Random position
 		// in range [-s_FieldHeight/2+2, s_FieldHeight/2-2]
-		{0, rand() % (fieldHeight_ - 3) + 2 - (fieldHeight_ / 2), 0});
+		{0, random.Range(2, fieldHeight_ - 2) - (fieldHeight_ / 2), 0});
 }
 
 void ping_pong::CreatePingPongBall(float tileSize_, ColorRGBA color_, Vector3 speed_, Vector3 pos_)
@@ -60,6 +59,8 @@ void ping_pong::CreatePingPongBall(float tileSize_, ColorRGBA color_, Vector3 sp
 	auto& col = reg.emplace<SimpleCollision>(entity);
 	col.size.x = tileSize_;
 	col.size.y = tileSize_;
+	col.layer = PingPongBall::s_Layer;
+	col.ccd = true;
 }
 
 void PingPongGame::CoreSystemsSetup()
@@ -72,6 +73,7 @@ void PingPongGame::CoreSystemsSetup()
 	engine.AddSystem<TextureSystem>();
 	engine.AddPausableSystem<TransformSystem>();
 	engine.AddSystem<SpriteRenderSystem>();
+	engine.AddSystem<TextSystem>();
 	engine.AddPausableSystem<AnimationSystem>();
 #if !defined(NDEBUG)
 	engine.AddSystem<DiagnosticSystem>();
@@ -169,6 +171,7 @@ void ping_pong::SetupWorld()
 			auto& col = reg.emplace<SimpleCollision>(entity);
 			col.size.x = tileSize * (width - 2) * (1 + space);
 			col.size.y = tileSize;
+			col.isStatic = true;
 
 			auto& transform = reg.emplace<Transform>(entity);
 			transform.position.x = 0;
@@ -184,6 +187,7 @@ void ping_pong::SetupWorld()
 			auto& col = reg.emplace<SimpleCollision>(entity);
 			col.size.x = tileSize * (width - 2) * (1 + space);
 			col.size.y = tileSize;
+			col.isStatic = true;
 
 			auto& transform = reg.emplace<Transform>(entity);
 			transform.position.x = 0;
@@ -197,6 +201,7 @@ void ping_pong::SetupWorld()
 			auto& col = reg.emplace<SimpleCollision>(entity);
 			col.size.x = tileSize;
 			col.size.y = tileSize * (height - 2) * (1 + space);
+			col.isStatic = true;
 
 			auto& transform = reg.emplace<Transform>(entity);
 			transform.position.x = (0.5f - static_cast<float>(width * (1 + space)) / 2.f) * tileSize;
@@ -213,6 +218,7 @@ void ping_pong::SetupWorld()
 			auto& col = reg.emplace<SimpleCollision>(entity);
 			col.size.x = tileSize;
 			col.size.y = tileSize * (height - 2) * (1 + space);
+			col.isStatic = true;
 
 			auto& transform = reg.emplace<Transform>(entity);
 			transform.position.x =
@@ -2,6 +2,7 @@
 
 #include "core/engine.h"
 #include "core/game/transforms.h"
+#include "core/input/inputs.h"
 
 using namespace dagger;
 using namespace ping_pong;
@@ -11,43 +12,6 @@ Float32 PingPongPlayerInputSystem::s_BoarderUp = 20;
 
 Float32 PingPongPlayerInputSystem::s_PlayerSpeed = 1.f;
 
-void PingPongPlayerInputSystem::SpinUp()
-{
-	Engine::Dispatcher().sink<KeyboardEvent>().connect<&PingPongPlayerInputSystem::OnKeyboardEvent>(this);
-}
-
-void PingPongPlayerInputSystem::WindDown()
-{
-	Engine::Dispatcher().sink<KeyboardEvent>().disconnect<&PingPongPlayerInputSystem::OnKeyboardEvent>(this);
-}
-
-void PingPongPlayerInputSystem::OnKeyboardEvent(KeyboardEvent kEvent_)
-{
-	Engine::Registry().view<ControllerMapping>().each(
-		[&](ControllerMapping& ctrl_)
-		{
-			if (kEvent_.key == ctrl_.upKey &&
-				(kEvent_.action == EDaggerInputState::Pressed || kEvent_.action == EDaggerInputState::Held))
-			{
-				ctrl_.input.y = 1;
-			}
-			else if (kEvent_.key == ctrl_.upKey && kEvent_.action == EDaggerInputState::Released && ctrl_.input.y > 0)
-			{
-				ctrl_.input.y = 0;
-			}
-			else if (
-				kEvent_.key == ctrl_.downKey &&
-				(kEvent_.action == EDaggerInputState::Held || kEvent_.action == EDaggerInputState::Pressed))
-			{
-				ctrl_.input.y = -1;
-			}
-			else if (kEvent_.key == ctrl_.downKey && kEvent_.action == EDaggerInputState::Released && ctrl_.input.y < 0)
-			{
-				ctrl_.input.y = 0;
-			}
-		});
-}
-
 void PingPongPlayerInputSystem::Run()
 {
 	auto view = Engine::Registry().view<Transform, ControllerMapping>();
@@ -56,6 +20,11 @@ void PingPongPlayerInputSystem::Run()
 		auto& t = view.get<Transform>(entity);
 		auto& ctrl = view.get<ControllerMapping>(entity);
 
+		// polled rather than taken from keyboard events, so replays drive it the same as live input
+		const Float32 up = Input::IsInputDown(ctrl.upKey) ? 1.0f : 0.0f;
+		const Float32 down = Input::IsInputDown(ctrl.downKey) ? 1.0f : 0.0f;
+		ctrl.input.y = up - down;
+
 		t.position.y += ctrl.input.y * s_PlayerSpeed * Engine::DeltaTime();
 
 		if (t.position.y > s_BoarderUp)
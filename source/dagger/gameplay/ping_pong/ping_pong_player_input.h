@@ -28,8 +28,6 @@ namespace ping_pong
 			return "PingPong Player Input System";
 		}
 
-		void SpinUp() override;
-		void WindDown() override;
 		void Run() override;
 
 		static void SetupPlayerOneInput(ControllerMapping& controllerMapping_)
@@ -49,8 +47,5 @@ namespace ping_pong
 			s_BoarderUp = boarderUp_;
 			s_BoarderDown = boarderDown_;
 		}
-
-	private:
-		void OnKeyboardEvent(KeyboardEvent kEvent_);
 	};
 } // namespace ping_pong
\ No newline at end of file
@@ -63,7 +63,8 @@ void PlayerScoresSystem::Run()
 			if (ps.score != m_GoalsPlayerOne)
 			{
 				ps.score = m_GoalsPlayerOne;
-				txt.Set("pixel-font", std::to_string(m_GoalsPlayerOne), {-(s_FieldWidth + 3) * s_TileSize / 2, 80, 0});
+				txt.Set(
+					"pixel-font-sdf", std::to_string(m_GoalsPlayerOne), {-(s_FieldWidth + 3) * s_TileSize / 2, 80, 0});
 			}
 		}
 		else
@@ -71,7 +72,8 @@ void PlayerScoresSystem::Run()
 			if (ps.score != m_GoalsPlayerTwo)
 			{
 				ps.score = m_GoalsPlayerTwo;
-				txt.Set("pixel-font", std::to_string(m_GoalsPlayerTwo), {(s_FieldWidth + 5) * s_TileSize / 2, 80, 0});
+				txt.Set(
+					"pixel-font-sdf", std::to_string(m_GoalsPlayerTwo), {(s_FieldWidth + 5) * s_TileSize / 2, 80, 0});
 			}
 		}
 	}
@@ -5,10 +5,18 @@
 #include "core/graphics/animation.h"
 #include "core/graphics/sprite.h"
 #include "core/input/inputs.h"
+#include "gameplay/common/tile_collision.h"
 #include "gameplay/platformer/platformer_controller.h"
 
 using namespace dagger;
 
+namespace
+{
+	const UInt32 s_RunCommand = InputCommands::Id("run");
+	const UInt32 s_JumpCommand = InputCommands::Id("jump");
+	const UInt32 s_DownCommand = InputCommands::Id("down");
+} // namespace
+
 // Idle
 
 void CharacterControllerFSM::Idle::Enter(CharacterControllerFSM::StateComponent& state_)
@@ -21,9 +29,22 @@ DEFAULT_EXIT(CharacterControllerFSM, Idle);
 
 void CharacterControllerFSM::Idle::Run(CharacterControllerFSM::StateComponent& state_)
 {
-	auto& input = Engine::Registry().get<InputReceiver>(state_.entity);
+	auto&& [input, body, character] =
+		Engine::Registry().get<InputReceiver, TileBody, platformer::PlatformerCharacter>(state_.entity);
 
-	if (EPSILON_NOT_ZERO(input.Get("run")))
+	body.velocity.x = 0;
+	body.dropThrough = EPSILON_NOT_ZERO(input.Get(s_DownCommand));
+
+	if (EPSILON_NOT_ZERO(input.Get(s_JumpCommand)) && body.onGround)
+	{
+		body.velocity.y = character.jumpSpeed;
+		GoTo(ECharacterStates::Airborne, state_);
+	}
+	else if (!body.onGround)
+	{
+		GoTo(ECharacterStates::Airborne, state_);
+	}
+	else if (EPSILON_NOT_ZERO(input.Get(s_RunCommand)))
 	{
 		GoTo(ECharacterStates::Running, state_);
 	}
@@ -42,18 +63,61 @@ void CharacterControllerFSM::Running::Exit(CharacterControllerFSM::StateComponen
 
 void CharacterControllerFSM::Running::Run(CharacterControllerFSM::StateComponent& state_)
 {
-	auto&& [sprite, input, character] =
-		Engine::Registry().get<Sprite, InputReceiver, platformer::PlatformerCharacter>(state_.entity);
+	auto&& [sprite, input, body, character] =
+		Engine::Registry().get<Sprite, InputReceiver, TileBody, platformer::PlatformerCharacter>(state_.entity);
 
-	Float32 run = input.Get("run");
+	Float32 run = input.Get(s_RunCommand);
+	body.dropThrough = EPSILON_NOT_ZERO(input.Get(s_DownCommand));
 
-	if (EPSILON_ZERO(run))
+	if (EPSILON_NOT_ZERO(input.Get(s_JumpCommand)) && body.onGround)
+	{
+		body.velocity.y = character.jumpSpeed;
+		GoTo(ECharacterStates::Airborne, state_);
+	}
+	else if (!body.onGround)
+	{
+		GoTo(ECharacterStates::Airborne, state_);
+	}
+	else if (EPSILON_ZERO(run))
 	{
 		GoTo(ECharacterStates::Idle, state_);
 	}
 	else
 	{
+		// the tile collision system moves the sprite, walls and slopes included
 		sprite.scale.x = run;
-		sprite.position.x += character.speed * sprite.scale.x * Engine::DeltaTime();
+		body.velocity.x = character.speed * sprite.scale.x;
 	}
 }
+
+// Airborne
+
+void CharacterControllerFSM::Airborne::Enter(CharacterControllerFSM::StateComponent& state_)
+{
+	auto& animator = Engine::Registry().get<Animator>(state_.entity);
+	AnimatorPlay(animator, "souls_like_knight_character:FALLING");
+}
+
+DEFAULT_EXIT(CharacterControllerFSM, Airborne);
+
+void CharacterControllerFSM::Airborne::Run(CharacterControllerFSM::StateComponent& state_)
+{
+	auto&& [sprite, input, body, character] =
+		Engine::Registry().get<Sprite, InputReceiver, TileBody, platformer::PlatformerCharacter>(state_.entity);
+
+	Float32 run = input.Get(s_RunCommand);
+
+	// holding down keeps falling through one-way tiles, letting go lands on the next one
+	body.dropThrough = EPSILON_NOT_ZERO(input.Get(s_DownCommand));
+
+	if (body.onGround)
+	{
+		GoTo(EPSILON_ZERO(run) ? ECharacterStates::Idle : ECharacterStates::Running, state_);
+		return;
+	}
+
+	// still steerable while in the air
+	if (EPSILON_NOT_ZERO(run))
+		sprite.scale.x = run;
+	body.velocity.x = character.speed * run;
+}
@@ -5,17 +5,20 @@
 enum struct ECharacterStates
 {
 	Idle,
-	Running
+	Running,
+	Airborne
 };
 
 struct CharacterControllerFSM : public FSM<ECharacterStates>
 {
 	DEFINE_STATE(CharacterControllerFSM, ECharacterStates, Idle);
 	DEFINE_STATE(CharacterControllerFSM, ECharacterStates, Running);
+	DEFINE_STATE(CharacterControllerFSM, ECharacterStates, Airborne);
 
 	CharacterControllerFSM()
 	{
 		CONNECT_STATE(ECharacterStates, Idle);
 		CONNECT_STATE(ECharacterStates, Running);
+		CONNECT_STATE(ECharacterStates, Airborne);
 	}
 };
@@ -11,6 +11,7 @@ namespace platformer
 	struct PlatformerCharacter
 	{
 		int speed {1};
+		Float32 jumpSpeed {0.0f};
 	};
 
 	class PlatformerControllerSystem : public System
@@ -14,6 +14,7 @@
 #include "core/graphics/text.h"
 #include "core/graphics/textures.h"
 #include "core/input/inputs.h"
+#include "gameplay/common/tile_collision.h"
 #include "gameplay/platformer/camera_focus.h"
 #include "gameplay/platformer/parallax.h"
 #include "gameplay/platformer/platformer_controller.h"
@@ -27,6 +28,7 @@ void Platformer::GameplaySystemsSetup()
 	auto& engine = Engine::Instance();
 
 	engine.AddSystem<PlatformerControllerSystem>();
+	engine.AddSystem<TileCollisionSystem>();
 	engine.AddSystem<ParallaxSystem>();
 	engine.AddSystem<CameraFollowSystem>();
 }
@@ -48,6 +50,7 @@ struct Character
 	Animator& animator;
 	InputReceiver& input;
 	PlatformerCharacter& character;
+	TileBody& body;
 
 	static Character Get(Entity entity_)
 	{
@@ -56,8 +59,9 @@ struct Character
 		auto& anim = reg.get_or_emplace<Animator>(entity_);
 		auto& input = reg.get_or_emplace<InputReceiver>(entity_);
 		auto& character = reg.get_or_emplace<PlatformerCharacter>(entity_);
+		auto& body = reg.get_or_emplace<TileBody>(entity_);
 
-		return Character {entity_, sprite, anim, input, character};
+		return Character {entity_, sprite, anim, input, character, body};
 	}
 
 	static Character Create(String input_ = "", ColorRGB color_ = {1, 1, 1}, Vector2 position_ = {0, 0})
@@ -77,9 +81,15 @@ struct Character
 		AnimatorPlay(chr.animator, "souls_like_knight_character:IDLE");
 
 		if (!input_.empty())
-			chr.input.contexts.push_back(input_);
+			chr.input.AddContext(input_);
 
 		chr.character.speed = 50;
+		chr.character.jumpSpeed = 350;
+
+		// the knight stands on the bottom edge of its sprite
+		chr.body.size = {20, 40};
+		chr.body.offset = {0, (chr.body.size.y - chr.sprite.size.y) / 2};
+		chr.body.gravity = 600;
 
 		return chr;
 	}
@@ -99,6 +109,26 @@ void CreateBackdrop()
 		sprite.size = {200, 200};
 		sprite.scale = {10, 1};
 		sprite.position = {0, -125, 1};
+
+		// 25 unit cells over the terrain: solid ground, and a ledge that can be jumped onto from below
+		auto& grid = reg.emplace<TileGrid>(back);
+		grid.origin = {-1000, -225};
+		grid.tileSize = 25;
+		grid.Resize(80, 16);
+		grid.Fill(0, 0, 79, 7, ETileShape::Solid);
+		grid.Fill(46, 10, 51, 10, ETileShape::OneWay);
+
+		Engine::PutDefaultResource<TileGrid>(&grid);
+	}
+
+	/* Show the ledge */ {
+		auto entity = reg.create();
+		auto& sprite = reg.get_or_emplace<Sprite>(entity);
+
+		AssignSprite(sprite, "EmptyWhitePixel");
+		sprite.color = {0, 0, 0, 1};
+		sprite.size = {150, 4};
+		sprite.position = {225, 48, 1};
 	}
 
 	/* Put background image */ {
@@ -135,7 +165,7 @@ void CreateBackdrop()
 		auto ui = reg.create();
 		auto& text = reg.emplace<Text>(ui);
 		text.spacing = 0.6f;
-		text.Set("pixel-font", "hello world");
+		text.Set("pixel-font-sdf", "hello world");
 	}
 }
 
@@ -146,9 +176,9 @@ void Platformer::WorldSetup()
 	SetCamera();
 	CreateBackdrop();
 
-	auto mainChar = Character::Create("ASDW", {1, 1, 1}, {-100, 0});
+	auto mainChar = Character::Create("ASDW", {1, 1, 1}, {-100, 60});
 	Engine::Registry().emplace<CameraFollowFocus>(mainChar.entity);
 
-	auto sndChar = Character::Create("Arrows", {1, 0, 0}, {100, 0});
+	auto sndChar = Character::Create("Arrows", {1, 0, 0}, {100, 60});
 	Engine::Registry().emplace<CameraFollowFocus>(sndChar.entity);
 }
@@ -7,6 +7,11 @@
 using namespace dagger;
 using namespace racing_game;
 
+void RacingCarSystem::SpinUp()
+{
+	m_Random = Random::Stream(SystemName());
+}
+
 void RacingCarSystem::Run()
 {
 	RacingGameFieldSettings fieldSettings;
@@ -26,7 +31,7 @@ void RacingCarSystem::Run()
 		if (t.position.y < -boarderY)
 		{
 			t.position.y = boarderY;
-			car.speed = fieldSettings.fieldTileSize * (rand() % 5 + 3);
+			car.speed = fieldSettings.fieldTileSize * m_Random.Range(3, 7);
 		}
 	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/core.h"
+#include "core/random.h"
 #include "core/system.h"
 
 using namespace dagger;
@@ -14,12 +15,15 @@ namespace racing_game
 
 	class RacingCarSystem : public System
 	{
+		RandomStream m_Random;
+
 	public:
 		inline String SystemName() const override
 		{
 			return "Racing Cars System";
 		}
 
+		void SpinUp() override;
 		void Run() override;
 	};
 } // namespace racing_game
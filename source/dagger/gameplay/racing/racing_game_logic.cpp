@@ -11,33 +11,24 @@ using namespace racing_game;
 
 void RacingCollisionsLogicSystem::SpinUp()
 {
+	Engine::Dispatcher().sink<ContactsBegan>().connect<&RacingCollisionsLogicSystem::OnContactsBegan>(this);
 	Engine::Dispatcher().sink<NextFrame>().connect<&RacingCollisionsLogicSystem::OnEndOfFrame>(this);
 }
 
 void RacingCollisionsLogicSystem::WindDown()
 {
+	Engine::Dispatcher().sink<ContactsBegan>().disconnect<&RacingCollisionsLogicSystem::OnContactsBegan>(this);
 	Engine::Dispatcher().sink<NextFrame>().disconnect<&RacingCollisionsLogicSystem::OnEndOfFrame>(this);
 }
 
-void RacingCollisionsLogicSystem::Run()
+void RacingCollisionsLogicSystem::OnContactsBegan(ContactsBegan contacts_)
 {
-	RacingGameFieldSettings fieldSettings;
+	auto& reg = Engine::Registry();
+	for (const auto& contact : *contacts_.contacts)
 	{
-		auto* ptr = Engine::GetDefaultResource<RacingGameFieldSettings>();
-		assert(ptr != nullptr);
-		fieldSettings = *ptr;
-
-		auto view = Engine::Registry().view<RacingPlayerCar, Transform, SimpleCollision>();
-		for (auto entity : view)
+		if (reg.all_of<RacingPlayerCar>(contact.a) || reg.all_of<RacingPlayerCar>(contact.b))
 		{
-			// auto &t = view.get<Transform>(entity);
-			// auto &player = view.get<RacingPlayerCar>(entity);
-			auto& col = view.get<SimpleCollision>(entity);
-
-			if (col.colided)
-			{
-				m_Restart = true;
-			}
+			m_Restart = true;
 		}
 	}
 }
@@ -2,6 +2,7 @@
 
 #include "core/core.h"
 #include "core/system.h"
+#include "gameplay/common/simple_collisions.h"
 
 using namespace dagger;
 
@@ -29,7 +30,9 @@ namespace racing_game
 		int scores = 0;
 	};
 
-	class RacingCollisionsLogicSystem : public System
+	class RacingCollisionsLogicSystem
+		: public System
+		, public Subscriber<ContactsBegan, NextFrame>
 	{
 		bool m_Restart = false;
 
@@ -41,9 +44,9 @@ namespace racing_game
 
 		void SpinUp() override;
 		void WindDown() override;
-		void Run() override;
 
 	private:
+		void OnContactsBegan(ContactsBegan contacts_);
 		void OnEndOfFrame();
 	};
 } // namespace racing_game
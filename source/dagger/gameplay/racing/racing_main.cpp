@@ -122,7 +122,8 @@ void racing_game::SetupWorld()
 	// collisions for road bounds
 
 	// other cars
-	int amountOfCars = rand() % 3 + 3;
+	auto& random = Random::Thread();
+	int amountOfCars = random.Range(3, 5);
 	for (int i = 0; i < amountOfCars; i++)
 	{
 		auto entity = reg.create();
@@ -136,7 +137,7 @@ void racing_game::SetupWorld()
 		transform.position = {tileSize * (3 * (i + 1) - width / 2), tileSize * (-i * 2 + heigh / 2), zPos};
 
 		auto& racingCar = reg.emplace<RacingCar>(entity);
-		racingCar.speed = tileSize * (rand() % 5 + 3);
+		racingCar.speed = tileSize * random.Range(3, 7);
 
 		auto& col = reg.emplace<SimpleCollision>(entity);
 		col.size = sprite.size;
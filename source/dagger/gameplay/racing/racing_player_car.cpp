@@ -2,49 +2,12 @@
 
 #include "core/engine.h"
 #include "core/game/transforms.h"
+#include "core/input/inputs.h"
 #include "gameplay/racing/racing_game_logic.h"
 
 using namespace dagger;
 using namespace racing_game;
 
-void RacingPlayerInputSystem::SpinUp()
-{
-	Engine::Dispatcher().sink<KeyboardEvent>().connect<&RacingPlayerInputSystem::OnKeyboardEvent>(this);
-}
-
-void RacingPlayerInputSystem::WindDown()
-{
-	Engine::Dispatcher().sink<KeyboardEvent>().disconnect<&RacingPlayerInputSystem::OnKeyboardEvent>(this);
-}
-
-void RacingPlayerInputSystem::OnKeyboardEvent(KeyboardEvent kEvent_)
-{
-	Engine::Registry().view<ControllerMapping>().each(
-		[&](ControllerMapping& ctrl_)
-		{
-			if (kEvent_.key == ctrl_.leftKey &&
-				(kEvent_.action == EDaggerInputState::Pressed || kEvent_.action == EDaggerInputState::Held))
-			{
-				ctrl_.input.x = -1;
-			}
-			else if (kEvent_.key == ctrl_.leftKey && kEvent_.action == EDaggerInputState::Released && ctrl_.input.x < 0)
-			{
-				ctrl_.input.x = 0;
-			}
-			else if (
-				kEvent_.key == ctrl_.rightKey &&
-				(kEvent_.action == EDaggerInputState::Held || kEvent_.action == EDaggerInputState::Pressed))
-			{
-				ctrl_.input.x = 1;
-			}
-			else if (
-				kEvent_.key == ctrl_.rightKey && kEvent_.action == EDaggerInputState::Released && ctrl_.input.x > 0)
-			{
-				ctrl_.input.x = 0;
-			}
-		});
-}
-
 void RacingPlayerInputSystem::Run()
 {
 	RacingGameFieldSettings fieldSettings;
@@ -59,6 +22,11 @@ void RacingPlayerInputSystem::Run()
 		auto& ctrl = view.get<ControllerMapping>(entity);
 		auto& car = view.get<RacingPlayerCar>(entity);
 
+		// polled rather than taken from keyboard events, so replays drive it the same as live input
+		const Float32 right = Input::IsInputDown(ctrl.rightKey) ? 1.0f : 0.0f;
+		const Float32 left = Input::IsInputDown(ctrl.leftKey) ? 1.0f : 0.0f;
+		ctrl.input.x = right - left;
+
 		t.position.x += ctrl.input.x * car.horzSpeed * Engine::DeltaTime();
 
 		Float32 boarderX = fieldSettings.GetXBoarder();
@@ -28,11 +28,6 @@ namespace racing_game
 			return "Racing Player Input System";
 		}
 
-		void SpinUp() override;
-		void WindDown() override;
 		void Run() override;
-
-	private:
-		void OnKeyboardEvent(KeyboardEvent kEvent_);
 	};
 } // namespace racing_game
@@ -8,6 +8,7 @@
 #include "core/graphics/shaders.h"
 #include "core/graphics/sprite.h"
 #include "core/input/inputs.h"
+#include "gameplay/common/rigid_body.h"
 #include "gameplay/common/simple_collisions.h"
 
 using namespace dagger;
@@ -17,6 +18,7 @@ void TeamGame::GameplaySystemsSetup()
 {
 	auto& engine = Engine::Instance();
 	engine.AddSystem<SimpleCollisionsSystem>();
+	engine.AddSystem<RigidBodySystem>();
 }
 
 void TeamGame::WorldSetup()
@@ -51,5 +53,25 @@ void team_game::SetupWorld()
 
 		auto& col = reg.emplace<SimpleCollision>(entity);
 		col.size = sprite.size;
+		col.isStatic = true;
+	}
+
+	// a few boxes dropped onto the logo, to show RigidBodySystem stacking them
+	for (int i = 0; i < 5; i++)
+	{
+		auto entity = reg.create();
+		auto& sprite = reg.emplace<Sprite>(entity);
+		AssignSprite(sprite, "EmptyWhitePixel");
+		sprite.color = {0.8f, 0.3f, 0.2f, 1};
+		sprite.size = {40, 40};
+
+		auto& transform = reg.emplace<Transform>(entity);
+		transform.position = {-80.0f + i * 35.0f, 320.0f + i * 60.0f, zPos - 0.5f};
+
+		auto& col = reg.emplace<SimpleCollision>(entity);
+		col.size = sprite.size;
+
+		auto& body = reg.emplace<RigidBody>(entity);
+		body.restitution = 0.2f;
 	}
 }
@@ -23,13 +23,14 @@ void TilesExampleMain::GameplaySystemsSetup() { }
 void TilesExampleMain::WorldSetup()
 {
 	auto& reg = Engine::Registry();
+	auto& random = Random::Thread();
 	for (int i = -50; i < 50; i++)
 	{
 		for (int j = -50; j < 50; j++)
 		{
 			auto entity = reg.create();
 			auto& sprite = reg.emplace<Sprite>(entity);
-			AssignSprite(sprite, fmt::format("spritesheets:dungeon:floor_{}", 1 + (rand() % 8)));
+			AssignSprite(sprite, fmt::format("spritesheets:dungeon:floor_{}", random.Range(1, 8)));
 			sprite.position = {i * 16, j * 16, 99};
 		}
 	}
@@ -39,7 +40,7 @@ void TilesExampleMain::WorldSetup()
 		auto goblin = reg.create();
 		auto& sprite = reg.emplace<Sprite>(goblin);
 		AssignSprite(sprite, "spritesheets:dungeon:goblin_idle_anim:1");
-		sprite.position = {rand() % 300 - 150, rand() % 300 - 150, 0};
+		sprite.position = {random.Range(-150, 149), random.Range(-150, 149), 0};
 		sprite.position.z = (150.0f + sprite.position.y) / 10.0f;
 		sprite.scale = {3, 3};
 
@@ -50,6 +51,6 @@ void TilesExampleMain::WorldSetup()
 	auto ui = reg.create();
 	auto& text = reg.emplace<Text>(ui);
 	text.spacing = 0.6f;
-	text.Set("pixel-font", "hello world");
-	text.Set("pixel-font", "new text", {10, -200, 0});
+	text.Set("pixel-font-sdf", "hello world");
+	text.Set("pixel-font-sdf", "new text", {10, -200, 0});
 }
\ No newline at end of file
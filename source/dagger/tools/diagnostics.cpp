@@ -1,7 +1,10 @@
 
 #include "tools/diagnostics.h"
 
+#include "core/audio.h"
 #include "core/engine.h"
+#include "core/graphics/gl_state.h"
+#include "core/graphics/gpu_timer.h"
 #include "core/graphics/window.h"
 #include "core/input/inputs.h"
 #include "tools/plotvar.h"
@@ -27,6 +30,44 @@ void DiagnosticSystem::RenderGUI() const
 	ImGui::PlotVar("FPS", (Float32)m_LastFrameCounter);
 	ImGui::Separator();
 
+	if (ImGui::CollapsingHeader("Timings (ms)"))
+	{
+#if defined(MEASURE_SYSTEMS)
+		ImGui::Text("CPU");
+		for (const auto& [name, length] : m_SystemStats)
+		{
+			ImGui::Text("  %-24s %8.3f", name.c_str(), length * 1000.0f);
+		}
+#endif // defined(MEASURE_SYSTEMS)
+
+		ImGui::Text("GPU");
+		if (auto* timer = Engine::GetDefaultResource<GPUTimer>())
+		{
+			for (const auto& timing : timer->Timings())
+			{
+				ImGui::Text("  %-24s %8.3f", timing.name.c_str(), timing.milliseconds);
+			}
+		}
+	}
+
+	{
+		auto stateStats = GLState::LastFrameStats();
+		ImGui::Text("GL state changes: %u issued, %u skipped", stateStats.issued, stateStats.skipped);
+	}
+
+	if (auto* audio = Engine::GetDefaultResource<Audio>())
+	{
+		auto audioStats = audio->Stats();
+		ImGui::Text(
+			"Sounds: %u of %u decoded, %.1f/%.1f MB, %u evicted", audioStats.resident, audioStats.registered,
+			audioStats.residentBytes / (1024.0f * 1024.0f), audioStats.budgetBytes / (1024.0f * 1024.0f),
+			audioStats.evictions);
+		ImGui::Text(
+			"Voices: %u/%u mixed, %u virtual, %u stolen, %u rejected", audioStats.activeVoices,
+			audioStats.maxActiveVoices, audioStats.virtualVoices, audioStats.stolenVoices, audioStats.rejectedVoices);
+	}
+	ImGui::Separator();
+
 	{
 		auto cursorInWindow = dagger::Input::CursorPositionInWindow();
 		ImGui::Text("Window: %f %f", cursorInWindow.x, cursorInWindow.y);
@@ -92,6 +133,33 @@ void DiagnosticSystem::Run()
 		m_SystemTimeCounter = 0.0;
 #endif // defined(MEASURE_SYSTEMS)
 
+		auto stateStats = GLState::LastFrameStats();
+		Logger::trace("GL state changes: {} issued, {} skipped", stateStats.issued, stateStats.skipped);
+
+		if (auto* audio = Engine::GetDefaultResource<Audio>())
+		{
+			auto audioStats = audio->Stats();
+			Logger::trace(
+				"Sounds: {} of {} decoded, {} of {} bytes, {} evicted", audioStats.resident, audioStats.registered,
+				audioStats.residentBytes, audioStats.budgetBytes, audioStats.evictions);
+			Logger::trace(
+				"Voices: {}/{} mixed, {} virtual, {} stolen, {} rejected", audioStats.activeVoices,
+				audioStats.maxActiveVoices, audioStats.virtualVoices, audioStats.stolenVoices,
+				audioStats.rejectedVoices);
+		}
+
+		if (auto* timer = Engine::GetDefaultResource<GPUTimer>())
+		{
+			Logger::trace("Per-pass GPU measurements #{}", Engine::FrameCount());
+			for (const auto& timing : timer->Timings())
+			{
+				Logger::trace("  {:<30}:\t\t{:>10}ms", timing.name, timing.milliseconds);
+			}
+
+			// each trace covers only the second since the previous one
+			timer->Restart();
+		}
+
 		m_DeltaSum = 0.0;
 	}
 }